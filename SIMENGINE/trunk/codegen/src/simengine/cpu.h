@@ -10,4 +10,4 @@
 #define __HOST__
 #define __GLOBAL__
 
-static const char target[] = "cpu";
+#define TARGET_NAME "cpu"
@@ -6,6 +6,8 @@ int exec_cpu(solver_props *props, const char *outputs_dirname, double *progress,
   unsigned int ready_outputs[NUM_ITERATORS] = {0};
   int inputs_available = 1;
   unsigned int iterid = NUM_ITERATORS - 1;
+  unsigned int steady_steps = 0;
+  int settled;
 
   // Initialize all iterators to running
   for(i=0;i<NUM_ITERATORS;i++){
@@ -88,6 +90,11 @@ int exec_cpu(solver_props *props, const char *outputs_dirname, double *progress,
       }
     }
 
+    // Stop the instance once its states have settled for the whole window
+    if(STEADY_STATE_WINDOW && steady_steps >= STEADY_STATE_WINDOW){
+      steady_state_stop(props, modelid);
+    }
+
     // Capture outputs for final iteration
     for(i=0;i<NUM_ITERATORS;i++){
       if (props[i].last_iteration[modelid]) {
@@ -137,11 +144,15 @@ int exec_cpu(solver_props *props, const char *outputs_dirname, double *progress,
 
     // Main solver evaluation phase, including inprocess.
     // x[t+dt] = f(x[t])
+    settled = 1;
     for(i=0;i<NUM_ITERATORS;i++){
       if(props[i].running[modelid] && props[i].time[modelid] == min_time){
 	if(0 != solver_eval(&props[i], modelid)) {
 	  return ERRCOMP;
 	}
+	if(STEADY_STATE_WINDOW){
+	  settled &= steady_state_settled(&props[i], modelid);
+	}
 	// Now next_time == time + dt
 	dirty_states[i] = 1;
 	ready_outputs[i] = 1;
@@ -149,6 +160,7 @@ int exec_cpu(solver_props *props, const char *outputs_dirname, double *progress,
 	in_process(&props[i], modelid);
       }
     }
+    steady_steps = settled ? steady_steps + 1 : 0;
   }
   
   // Log any remaining outputs
@@ -14,7 +14,10 @@ int exec_loop(solver_props *props, const char *outputs_dirname, double *progress
 #if defined(TARGET_CPU)
   status = exec_cpu(props, outputs_dirname, progress, 0, resuming);
 #elif defined(TARGET_OPENMP)
-  status = exec_parallel_cpu(props, outputs_dirname, progress, resuming);
+  if(PARAREAL_SLICES > 1)
+    status = exec_parareal_cpu(props, outputs_dirname, progress, resuming);
+  else
+    status = exec_parallel_cpu(props, outputs_dirname, progress, resuming);
 #elif defined(TARGET_GPU)
   status = exec_parallel_gpu(props, outputs_dirname, progress, resuming);
 #else
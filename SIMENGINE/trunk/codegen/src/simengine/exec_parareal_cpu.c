@@ -0,0 +1,402 @@
+// Parareal parallel-in-time integration of a single model instance.
+//
+// The simulation interval is divided into time slices, one per parallel model slot.  A cheap
+// coarse propagator (forward Euler over a few large steps) sweeps the slices serially to predict
+// the state at the beginning of each one.  The model's own solvers then integrate every slice
+// concurrently from the predicted states, each slice in its own slot on its own processor core,
+// and the predictions are corrected by
+//     U[k+1] = G(U'[k]) + F(U[k]) - G(U[k])
+// where F is the fine (compiled solver) propagator, G the coarse propagator and U' the newly
+// corrected state.  Iteration stops once no slice boundary changes by more than the tolerance.
+// After j iterations the first j slices are exact, so the result never takes more than one
+// iteration per slice and never differs from a serial run by more than the tolerance.
+//
+// Each fine pass logs its outputs to a scratch directory per slice; the outputs of the final pass
+// are stitched together in time order into the outputs of the instance.
+//
+// See Lions, Maday and Turinici, "A 'parareal' in time discretization of PDE's", C. R. Acad.
+// Sci. Paris 332 (2001).
+// Copyright 2010 Simatra Modeling Technologies, L.L.C.
+
+#define PARAREAL_COARSE_STEPS 4
+
+// Number of values saved for a single instance across all iterators
+static unsigned int parareal_state_count(solver_props *props){
+  unsigned int i, count = 0;
+  for(i=0;i<NUM_ITERATORS;i++){
+    count += props[i].statesize + props[i].algebraic_statesize;
+  }
+  return count;
+}
+
+// Copies the states of all iterators for one slot into a contiguous vector
+static void parareal_get_states(solver_props *props, unsigned int modelid, CDATAFORMAT *u){
+  unsigned int i, j;
+  for(i=0;i<NUM_ITERATORS;i++){
+    CDATAFORMAT *algebraic_states = props[i].model_states + (props[i].statesize * PARALLEL_MODELS);
+    for(j=0;j<props[i].statesize;j++){
+      *u++ = props[i].model_states[TARGET_IDX(props[i].statesize, PARALLEL_MODELS, j, modelid)];
+    }
+    for(j=0;j<props[i].algebraic_statesize;j++){
+      *u++ = algebraic_states[TARGET_IDX(props[i].algebraic_statesize, PARALLEL_MODELS, j, modelid)];
+    }
+  }
+}
+
+// Loads a contiguous vector into the current and next states of all iterators for one slot
+static void parareal_set_states(solver_props *props, unsigned int modelid, const CDATAFORMAT *u){
+  unsigned int i, j, index;
+  for(i=0;i<NUM_ITERATORS;i++){
+    CDATAFORMAT *algebraic_states = props[i].model_states + (props[i].statesize * PARALLEL_MODELS);
+    CDATAFORMAT *algebraic_next_states = props[i].next_states + (props[i].statesize * PARALLEL_MODELS);
+    for(j=0;j<props[i].statesize;j++){
+      index = TARGET_IDX(props[i].statesize, PARALLEL_MODELS, j, modelid);
+      props[i].model_states[index] = props[i].next_states[index] = *u++;
+    }
+    for(j=0;j<props[i].algebraic_statesize;j++){
+      index = TARGET_IDX(props[i].algebraic_statesize, PARALLEL_MODELS, j, modelid);
+      algebraic_states[index] = algebraic_next_states[index] = *u++;
+    }
+  }
+}
+
+// Sets the iterators of one slot to begin at a given time
+static void parareal_set_time(solver_props *props, unsigned int modelid, CDATAFORMAT time){
+  unsigned int i;
+  for(i=0;i<NUM_ITERATORS;i++){
+    props[i].time[modelid] = time;
+    props[i].next_time[modelid] = time;
+    props[i].time_error[modelid] = 0;
+    props[i].count[modelid] = 0;
+    props[i].last_iteration[modelid] = 0;
+  }
+}
+
+// Coarse propagator: advances u from t0 to t1 by forward Euler over the continuous states,
+// leaving algebraic states as they are.  Uses the slot modelid as working space.
+static void parareal_coarse(solver_props *props, unsigned int modelid, CDATAFORMAT t0, CDATAFORMAT t1, CDATAFORMAT *dydt, const CDATAFORMAT *u, CDATAFORMAT *unext){
+  unsigned int i, j, step, index;
+  CDATAFORMAT h = (t1 - t0) / PARAREAL_COARSE_STEPS;
+  CDATAFORMAT t = t0;
+
+  parareal_set_states(props, modelid, u);
+  for(step=0;step<PARAREAL_COARSE_STEPS;step++){
+    parareal_set_time(props, modelid, t);
+    for(i=0;i<NUM_ITERATORS;i++){
+      if(props[i].statesize > 0){
+	model_flows(t, props[i].model_states, dydt, &props[i], 0, modelid);
+	for(j=0;j<props[i].statesize;j++){
+	  index = TARGET_IDX(props[i].statesize, PARALLEL_MODELS, j, modelid);
+	  props[i].model_states[index] += h * dydt[index];
+	}
+      }
+    }
+    t += h;
+  }
+  parareal_get_states(props, modelid, unext);
+}
+
+// Parareal requires that every slice can be started from nothing but its states and time.
+static int parareal_supported(solver_props *props, unsigned int slices){
+  unsigned int i;
+
+  if(props->num_models != 1){
+    WARN(Simatra:Simex:parareal, "Parareal integration applies only to a single model instance, running %d instances in parallel instead.\n", props->num_models);
+    return 0;
+  }
+  if(slices > PARALLEL_MODELS){
+    WARN(Simatra:Simex:parareal, "Parareal integration supports at most %d time slices in this simulation.\n", PARALLEL_MODELS);
+    return 0;
+  }
+  if(!simex_output_files || !binary_files){
+    WARN(Simatra:Simex:parareal, "Parareal integration requires binary output files.\n");
+    return 0;
+  }
+  if(STEADY_STATE_WINDOW){
+    WARN(Simatra:Simex:parareal, "Parareal integration does not support steady state detection.\n");
+    return 0;
+  }
+  if(NUM_SAMPLED_INPUTS + NUM_TIME_VALUE_INPUTS + NUM_EVENT_INPUTS > 0){
+    WARN(Simatra:Simex:parareal, "Parareal integration does not support time-varying inputs.\n");
+    return 0;
+  }
+  for(i=0;i<seint.num_iterators;i++){
+    if(0 == strcmp(seint.solver_names[i], "discrete") || 0 == strcmp(seint.solver_names[i], "cvode")){
+      WARN(Simatra:Simex:parareal, "Parareal integration does not support the %s solver.\n", seint.solver_names[i]);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Creates the scratch output directories of each slice under outputs_dirname/parareal
+static void parareal_make_directories(const char *parareal_dirname, unsigned int slices){
+  char slice_dirname[PATH_MAX];
+  unsigned int k;
+  int i;
+
+  if(mkdir(parareal_dirname, 0777) && errno != EEXIST){
+    ERROR(Simatra::Simex::parareal, "Could not create directory '%s'\n", parareal_dirname);
+  }
+  for(k=0;k<slices;k++){
+    sprintf(slice_dirname, "%s", parareal_dirname);
+    for(i=2;i>=0;i--){
+      sprintf((slice_dirname + strlen(slice_dirname)), "/%02x", BYTE(k, i));
+      if(mkdir(slice_dirname, 0777) && errno != EEXIST){
+	ERROR(Simatra::Simex::parareal, "Could not create intermediate directory '%s'\n", slice_dirname);
+      }
+    }
+    sprintf((slice_dirname + strlen(slice_dirname)), "/outputs");
+    if(mkdir(slice_dirname, 0777) && errno != EEXIST){
+      ERROR(Simatra::Simex::parareal, "Could not create directory '%s'\n", slice_dirname);
+    }
+  }
+}
+
+// Empties the scratch output files of a slice before it is integrated again
+static void parareal_clear_outputs(const char *parareal_dirname, unsigned int slice){
+  char slice_dirname[PATH_MAX];
+  char output_filename[PATH_MAX];
+  unsigned int outputid;
+
+  modelid_dirname(parareal_dirname, slice_dirname, slice);
+  for(outputid=0;outputid<seint.num_outputs;outputid++){
+    sprintf(output_filename, "%s/outputs/%s", slice_dirname, seint.output_names[outputid]);
+    unlink(output_filename);
+  }
+}
+
+// Appends the scratch outputs of all slices to the outputs of the instance.  Records repeated at
+// the start of a slice, i.e. no later than the last record of the previous slice, are dropped.
+static void parareal_stitch_outputs(const char *outputs_dirname, const char *parareal_dirname, unsigned int modelid, unsigned int slices){
+  char model_dirname[PATH_MAX];
+  char slice_dirname[PATH_MAX];
+  char output_filename[PATH_MAX];
+  unsigned int outputid, k;
+
+  modelid_dirname(outputs_dirname, model_dirname, modelid);
+
+  for(outputid=0;outputid<seint.num_outputs;outputid++){
+    unsigned int nquantities = seint.output_num_quantities[outputid];
+    double record[nquantities];
+    double last_time = -INFINITY;
+    FILE *output_file, *slice_file;
+
+    sprintf(output_filename, "%s/outputs/%s", model_dirname, seint.output_names[outputid]);
+    output_file = fopen(output_filename, "a");
+    if(NULL == output_file){
+      ERROR(Simatra::Simex::parareal, "could not open file '%s'\n", output_filename);
+    }
+
+    for(k=0;k<slices;k++){
+      int leading = 1;
+      modelid_dirname(parareal_dirname, slice_dirname, k);
+      sprintf(output_filename, "%s/outputs/%s", slice_dirname, seint.output_names[outputid]);
+      slice_file = fopen(output_filename, "r");
+      if(NULL == slice_file){
+	// No outputs were logged for this slice
+	continue;
+      }
+      while(nquantities == fread(record, sizeof(double), nquantities, slice_file)){
+	if(leading && record[0] <= last_time){
+	  continue;
+	}
+	leading = 0;
+	last_time = record[0];
+	fwrite(record, sizeof(double), nquantities, output_file);
+      }
+      fclose(slice_file);
+      unlink(output_filename);
+    }
+    fclose(output_file);
+  }
+
+  // Removes the scratch directories, each parent once it is empty
+  for(k=0;k<slices;k++){
+    modelid_dirname(parareal_dirname, slice_dirname, k);
+    sprintf(output_filename, "%s/outputs", slice_dirname);
+    rmdir(output_filename);
+    while(0 == rmdir(slice_dirname) && strlen(slice_dirname) > strlen(parareal_dirname)){
+      *strrchr(slice_dirname, '/') = 0;
+    }
+  }
+}
+
+// Integrates a single model instance with its time interval split into slices integrated in parallel
+int exec_parareal_cpu(solver_props *props, const char *outputs_dirname, double *progress, int resuming){
+  int ret = SUCCESS;
+  unsigned int slices = PARAREAL_SLICES;
+  unsigned int i, j, k, iteration;
+  unsigned long long n;
+  unsigned int num_values = parareal_state_count(props);
+  unsigned int max_statesize = 0;
+  unsigned int first_slice = 0;
+  CDATAFORMAT timestep = 0;
+  unsigned long long num_steps;
+  CDATAFORMAT boundaries[slices+1];
+  CDATAFORMAT final_time[NUM_ITERATORS];
+  char parareal_dirname[PATH_MAX];
+  double slice_progress[PARALLEL_MODELS];
+  CDATAFORMAT *u, *fine, *coarse, *unew, *dydt;
+
+  // Slice boundaries fall on whole multiples of the largest timestep, accumulated in the same
+  // order as the solvers accumulate time so that fixed step solvers reach them exactly.
+  for(i=0;i<NUM_ITERATORS;i++){
+    timestep = MAX(timestep, props[i].timestep);
+    max_statesize = MAX(max_statesize, props[i].statesize + props[i].algebraic_statesize);
+    final_time[i] = props[i].time[0];
+  }
+
+  if(!parareal_supported(props, slices) || 0 == num_values){
+    return exec_parallel_cpu(props, outputs_dirname, progress, resuming);
+  }
+  num_steps = timestep > 0 ? (unsigned long long)((props->stoptime - props->time[0]) / timestep) : 0;
+  if(num_steps < slices){
+    WARN(Simatra:Simex:parareal, "Simulation is too short to divide into %d time slices.\n", slices);
+    return exec_parallel_cpu(props, outputs_dirname, progress, resuming);
+  }
+  boundaries[0] = props->time[0];
+  for(k=1, n=0;k<slices;k++){
+    boundaries[k] = boundaries[k-1];
+    for(;n<(k*num_steps)/slices;n++){
+      boundaries[k] += timestep;
+    }
+  }
+  boundaries[slices] = props->stoptime;
+
+  u = (CDATAFORMAT*)malloc((slices+1)*num_values*sizeof(CDATAFORMAT));
+  unew = (CDATAFORMAT*)malloc((slices+1)*num_values*sizeof(CDATAFORMAT));
+  fine = (CDATAFORMAT*)malloc((slices+1)*num_values*sizeof(CDATAFORMAT));
+  coarse = (CDATAFORMAT*)malloc((slices+1)*num_values*sizeof(CDATAFORMAT));
+  dydt = (CDATAFORMAT*)malloc(max_statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  if(!u || !unew || !fine || !coarse || !dydt){
+    ERROR(Simatra::Simex::parareal, "Out of memory.\n");
+  }
+
+  sprintf(parareal_dirname, "%s/parareal", outputs_dirname);
+  parareal_make_directories(parareal_dirname, slices);
+
+  // Every slot simulates the same instance
+#if NUM_CONSTANT_INPUTS > 0
+  for(k=1;k<slices;k++){
+    for(i=0;i<NUM_CONSTANT_INPUTS;i++){
+      constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, i, k)] = constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, i, 0)];
+    }
+  }
+#endif
+#if NUM_PRECOMPUTED > 0
+  for(k=1;k<slices;k++){
+    for(i=0;i<NUM_PRECOMPUTED;i++){
+      precomputed_values[TARGET_IDX(NUM_PRECOMPUTED, PARALLEL_MODELS, i, k)] = precomputed_values[TARGET_IDX(NUM_PRECOMPUTED, PARALLEL_MODELS, i, 0)];
+    }
+  }
+#endif
+  for(i=0;i<NUM_ITERATORS;i++){
+    solver_free(&props[i]);
+    props[i].num_models = slices;
+  }
+
+  // Initial prediction by the coarse propagator alone
+  parareal_get_states(props, 0, u);
+  for(k=0;k<slices;k++){
+    parareal_coarse(props, k, boundaries[k], boundaries[k+1], dydt, &u[k*num_values], &coarse[(k+1)*num_values]);
+    memcpy(&u[(k+1)*num_values], &coarse[(k+1)*num_values], num_values*sizeof(CDATAFORMAT));
+  }
+
+  for(iteration=1;iteration<=slices && SUCCESS == ret;iteration++){
+    CDATAFORMAT max_change = 0;
+
+    // Fine propagation of every slice not yet known exactly, all slices at once
+    for(k=first_slice;k<slices;k++){
+      parareal_set_states(props, k, &u[k*num_values]);
+      parareal_set_time(props, k, boundaries[k]);
+      parareal_clear_outputs(parareal_dirname, k);
+    }
+    // Solvers restart from the new states of each slice
+    for(i=0;i<NUM_ITERATORS;i++){
+      solver_init(&props[i]);
+    }
+
+    // Each slice is its own iteration, so every slice is integrated however many threads run
+#pragma omp parallel for num_threads(slices - first_slice) schedule(static, 1) reduction(|:ret)
+    for(k=first_slice;k<slices;k++){
+      solver_props slice_props[NUM_ITERATORS];
+      unsigned int s;
+
+      memcpy(slice_props, props, NUM_ITERATORS*sizeof(solver_props));
+      for(s=0;s<NUM_ITERATORS;s++){
+	slice_props[s].starttime = boundaries[k];
+	slice_props[s].stoptime = boundaries[k+1];
+	slice_props[s].modelid_offset = 0;
+      }
+      ret |= exec_cpu(slice_props, parareal_dirname, slice_progress, k, k ? 1 : resuming);
+      parareal_get_states(props, k, &fine[(k+1)*num_values]);
+    }// Threads implicitly joined here
+
+    // The coarse propagator reuses the slots, so keep where the final slice ended
+    for(i=0;i<NUM_ITERATORS;i++){
+      final_time[i] = props[i].time[slices-1];
+      solver_free(&props[i]);
+    }
+
+    // Serial correction sweep.  The slice following the first inexact slice becomes exact.
+    memcpy(&unew[first_slice*num_values], &u[first_slice*num_values], num_values*sizeof(CDATAFORMAT));
+    for(k=first_slice;k<slices;k++){
+      CDATAFORMAT *g = &coarse[(k+1)*num_values];
+      CDATAFORMAT *f = &fine[(k+1)*num_values];
+      CDATAFORMAT *next = &unew[(k+1)*num_values];
+      CDATAFORMAT *prev = &u[(k+1)*num_values];
+
+      if(k == first_slice){
+	memcpy(next, f, num_values*sizeof(CDATAFORMAT));
+      }
+      else{
+	CDATAFORMAT gnew[num_values];
+	parareal_coarse(props, k, boundaries[k], boundaries[k+1], dydt, &unew[k*num_values], gnew);
+	for(j=0;j<num_values;j++){
+	  next[j] = gnew[j] + f[j] - g[j];
+	  g[j] = gnew[j];
+	}
+      }
+      if(k+1 < slices){
+	for(j=0;j<num_values;j++){
+	  max_change = MAX(max_change, fabs(next[j] - prev[j]) / (PARAREAL_TOLERANCE * (1 + fabs(prev[j]))));
+	}
+      }
+    }
+    memcpy(&u[first_slice*num_values], &unew[first_slice*num_values], (slices-first_slice+1)*num_values*sizeof(CDATAFORMAT));
+    first_slice++;
+
+    progress[0] = (double)first_slice / slices;
+    if(max_change <= 1){
+      break;
+    }
+  }
+
+  // The instance continues from the end of the final slice of the last fine pass
+  for(i=0;i<NUM_ITERATORS;i++){
+    props[i].num_models = 1;
+    solver_init(&props[i]);
+  }
+  parareal_set_states(props, 0, &fine[slices*num_values]);
+  for(i=0;i<NUM_ITERATORS;i++){
+    props[i].time[0] = props[i].next_time[0] = final_time[i];
+    // The instance is charged with the work of every slice
+    for(k=1;k<slices;k++){
+      props[i].stats[0].accepted += props[i].stats[k].accepted;
+      props[i].stats[0].rejected += props[i].stats[k].rejected;
+      props[i].stats[0].flows += props[i].stats[k].flows;
+    }
+  }
+
+  parareal_stitch_outputs(outputs_dirname, parareal_dirname, props->modelid_offset, slices);
+  progress[0] = 1;
+
+  free(u);
+  free(unew);
+  free(fine);
+  free(coarse);
+  free(dydt);
+
+  return ret;
+}
@@ -13,4 +13,4 @@
 #define __HOST__ __host__
 #define __GLOBAL__ __global__
 
-static const char target[] = "gpu";
+#define TARGET_NAME "gpu"
@@ -1,32 +1,3 @@
-
-// sort inputs with constants first, then samples, then time/value pairs and then events
-
-#define IS_CONSTANT_INPUT(inputid) (NUM_CONSTANT_INPUTS > 0 && inputid < NUM_CONSTANT_INPUTS)
-#define IS_SAMPLED_INPUT(inputid) (NUM_SAMPLED_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS && inputid < NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS)
-#define IS_TIME_VALUE_INPUT(inputid) (NUM_TIME_VALUE_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS && inputid < NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS + NUM_TIME_VALUE_INPUTS)
-#define IS_EVENT_INPUT(inputid) (NUM_EVENT_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS + NUM_TIME_VALUE_INPUTS)
-
-#define SAMPLED_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS)
-#define TIME_VALUE_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS - NUM_SAMPLED_INPUTS)
-#define EVENT_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS - NUM_SAMPLED_INPUTS - NUM_TIME_VALUE_INPUTS)
-
-// TODO : SET THIS VALUE BASED ON NUMBER OF SAMPLED INPUTS AND MEMORY AVAILABLE, SPECIFICALLY FOR GPU
-#define SAMPLE_BUFFER_SIZE 64
-
-typedef struct{
-  CDATAFORMAT data[ARRAY_SIZE * SAMPLE_BUFFER_SIZE];
-  CDATAFORMAT current_time[ARRAY_SIZE];
-  // index offset into the data buffer
-  int idx[ARRAY_SIZE];
-  // number of valid data elements
-  int buffered_size[ARRAY_SIZE];
-  // byte offset into the file which holds input data
-  long file_idx[ARRAY_SIZE];
-  CDATAFORMAT timestep;
-  sampled_eof_option_t eof_option;
-}sampled_input_t;
-
-
 typedef struct {
   int offset;
   int length;
@@ -275,79 +246,3 @@ void initialize_inputs(CDATAFORMAT *tmp_constant_inputs, sampled_input_t *tmp_sa
 #endif // NUM_SAMPLED_INPUTS > 0
 
 }
-
-
-#if NUM_SAMPLED_INPUTS > 0
-__HOST__ __DEVICE__ static inline CDATAFORMAT get_sampled_input(unsigned int inputid, unsigned int modelid, sampled_input_t *inputs){
-  sampled_input_t *input = &inputs[STRUCT_IDX * NUM_SAMPLED_INPUTS + SAMPLED_INPUT_ID(inputid)];
-
-  assert(input->idx[ARRAY_IDX] < SAMPLE_BUFFER_SIZE);
-
-  return (CDATAFORMAT)input->data[ARRAY_IDX * SAMPLE_BUFFER_SIZE + input->idx[ARRAY_IDX]];
-}
-#endif
-
-__HOST__ static inline CDATAFORMAT host_get_input(unsigned int inputid, unsigned int modelid) {
-  assert(inputid < NUM_INPUTS);
-#if NUM_CONSTANT_INPUTS > 0
-  if(IS_CONSTANT_INPUT(inputid)) {
-    return host_constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, inputid, modelid)];
-  }
-#endif
-
-#if NUM_SAMPLED_INPUTS > 0
-  if(IS_SAMPLED_INPUT(inputid)) {
-    return get_sampled_input(inputid, modelid, host_sampled_inputs);
-  }
-#endif
-
-#if NUM_TIME_VALUE_INPUTS > 0
-  if(IS_TIME_VALUE_INPUT(inputid)) {
-    ERROR(Simatra:Simex:get_input, "Time/value pair inputs not yet implemented.\n");
-  }
-#endif
-
-#if NUM_EVENT_INPUTS > 0
-  if(IS_EVENT_INPUT(inputid)) {
-    ERROR(Simatra:Simex:get_input, "Event inputs not yet implemented.\n");
-  }
-#endif
-
-  ERROR(Simatra:Simex:get_input, "No such input id %d.\n", inputid);
-}
-
-__HOST__ __DEVICE__ static inline CDATAFORMAT get_input(unsigned int inputid, unsigned int modelid){
-  assert(inputid < NUM_INPUTS);
-
-#if NUM_CONSTANT_INPUTS > 0
-  if(IS_CONSTANT_INPUT(inputid)) {
-    return constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, inputid, modelid)];
-  }
-#endif
-
-#if NUM_SAMPLED_INPUTS > 0
-  if(IS_SAMPLED_INPUT(inputid)) {
-    return get_sampled_input(inputid, modelid, sampled_inputs);
-  }
-#endif
-
-#ifdef TARGET_GPU
-  // No error reporting cabaility on the GPU
-  return NAN;
-#else
-
-#if NUM_TIME_VALUE_INPUTS > 0
-  if(IS_TIME_VALUE_INPUT(inputid)) {
-    ERROR(Simatra:Simex:get_input, "Time/value pair inputs not yet implemented.\n");
-  }
-#endif
-
-#if NUM_EVENT_INPUTS > 0
-  if(IS_EVENT_INPUT(inputid)) {
-    ERROR(Simatra:Simex:get_input, "Event inputs not yet implemented.\n");
-  }
-#endif
-
-  ERROR(Simatra:Simex:get_input, "No such input id %d.\n", inputid);
-#endif
-}
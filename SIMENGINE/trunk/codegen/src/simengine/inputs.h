@@ -0,0 +1,41 @@
+// Input data referenced by the flows, see inputs.c for their allocation and initialization.
+
+// sort inputs with constants first, then samples, then time/value pairs and then events
+
+#define IS_CONSTANT_INPUT(inputid) (NUM_CONSTANT_INPUTS > 0 && inputid < NUM_CONSTANT_INPUTS)
+#define IS_SAMPLED_INPUT(inputid) (NUM_SAMPLED_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS && inputid < NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS)
+#define IS_TIME_VALUE_INPUT(inputid) (NUM_TIME_VALUE_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS && inputid < NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS + NUM_TIME_VALUE_INPUTS)
+#define IS_EVENT_INPUT(inputid) (NUM_EVENT_INPUTS > 0 && inputid >= NUM_CONSTANT_INPUTS + NUM_SAMPLED_INPUTS + NUM_TIME_VALUE_INPUTS)
+
+#define SAMPLED_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS)
+#define TIME_VALUE_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS - NUM_SAMPLED_INPUTS)
+#define EVENT_INPUT_ID(inputid) (inputid - NUM_CONSTANT_INPUTS - NUM_SAMPLED_INPUTS - NUM_TIME_VALUE_INPUTS)
+
+// TODO : SET THIS VALUE BASED ON NUMBER OF SAMPLED INPUTS AND MEMORY AVAILABLE, SPECIFICALLY FOR GPU
+#define SAMPLE_BUFFER_SIZE 64
+
+typedef struct{
+  CDATAFORMAT data[ARRAY_SIZE * SAMPLE_BUFFER_SIZE];
+  CDATAFORMAT current_time[ARRAY_SIZE];
+  // index offset into the data buffer
+  int idx[ARRAY_SIZE];
+  // number of valid data elements
+  int buffered_size[ARRAY_SIZE];
+  // byte offset into the file which holds input data
+  long file_idx[ARRAY_SIZE];
+  CDATAFORMAT timestep;
+  sampled_eof_option_t eof_option;
+}sampled_input_t;
+
+
+#ifndef TARGET_GPU
+// Defined in inputs.c; the flows of the CPU targets may be compiled apart from it
+#if NUM_CONSTANT_INPUTS > 0
+extern CDATAFORMAT constant_inputs[PARALLEL_MODELS * NUM_CONSTANT_INPUTS];
+extern CDATAFORMAT *host_constant_inputs;
+#endif
+#if NUM_SAMPLED_INPUTS > 0
+extern sampled_input_t sampled_inputs[STRUCT_SIZE * NUM_SAMPLED_INPUTS];
+extern sampled_input_t *host_sampled_inputs;
+#endif
+#endif
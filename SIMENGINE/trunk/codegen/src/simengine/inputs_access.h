@@ -0,0 +1,76 @@
+// Accessors of the input data used by the flows and state initialization functions.
+
+#if NUM_SAMPLED_INPUTS > 0
+__HOST__ __DEVICE__ static inline CDATAFORMAT get_sampled_input(unsigned int inputid, unsigned int modelid, sampled_input_t *inputs){
+  sampled_input_t *input = &inputs[STRUCT_IDX * NUM_SAMPLED_INPUTS + SAMPLED_INPUT_ID(inputid)];
+
+  assert(input->idx[ARRAY_IDX] < SAMPLE_BUFFER_SIZE);
+
+  return (CDATAFORMAT)input->data[ARRAY_IDX * SAMPLE_BUFFER_SIZE + input->idx[ARRAY_IDX]];
+}
+#endif
+
+__HOST__ static inline CDATAFORMAT host_get_input(unsigned int inputid, unsigned int modelid) {
+  assert(inputid < NUM_INPUTS);
+#if NUM_CONSTANT_INPUTS > 0
+  if(IS_CONSTANT_INPUT(inputid)) {
+    return host_constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, inputid, modelid)];
+  }
+#endif
+
+#if NUM_SAMPLED_INPUTS > 0
+  if(IS_SAMPLED_INPUT(inputid)) {
+    return get_sampled_input(inputid, modelid, host_sampled_inputs);
+  }
+#endif
+
+#if NUM_TIME_VALUE_INPUTS > 0
+  if(IS_TIME_VALUE_INPUT(inputid)) {
+    ERROR(Simatra:Simex:get_input, "Time/value pair inputs not yet implemented.\n");
+  }
+#endif
+
+#if NUM_EVENT_INPUTS > 0
+  if(IS_EVENT_INPUT(inputid)) {
+    ERROR(Simatra:Simex:get_input, "Event inputs not yet implemented.\n");
+  }
+#endif
+
+  ERROR(Simatra:Simex:get_input, "No such input id %d.\n", inputid);
+}
+
+__HOST__ __DEVICE__ static inline CDATAFORMAT get_input(unsigned int inputid, unsigned int modelid){
+  assert(inputid < NUM_INPUTS);
+
+#if NUM_CONSTANT_INPUTS > 0
+  if(IS_CONSTANT_INPUT(inputid)) {
+    return constant_inputs[TARGET_IDX(NUM_CONSTANT_INPUTS, PARALLEL_MODELS, inputid, modelid)];
+  }
+#endif
+
+#if NUM_SAMPLED_INPUTS > 0
+  if(IS_SAMPLED_INPUT(inputid)) {
+    return get_sampled_input(inputid, modelid, sampled_inputs);
+  }
+#endif
+
+#ifdef TARGET_GPU
+  // No error reporting cabaility on the GPU
+  return NAN;
+#else
+
+#if NUM_TIME_VALUE_INPUTS > 0
+  if(IS_TIME_VALUE_INPUT(inputid)) {
+    ERROR(Simatra:Simex:get_input, "Time/value pair inputs not yet implemented.\n");
+  }
+#endif
+
+#if NUM_EVENT_INPUTS > 0
+  if(IS_EVENT_INPUT(inputid)) {
+    ERROR(Simatra:Simex:get_input, "Event inputs not yet implemented.\n");
+  }
+#endif
+
+  ERROR(Simatra:Simex:get_input, "No such input id %d.\n", inputid);
+#endif
+}
@@ -0,0 +1,60 @@
+// Lookup tables for expensive functions of a single state.
+//
+// Each table samples its function at evenly spaced points over the Range of the state. The
+// number of intervals is doubled until linear interpolation reproduces the function within
+// LOOKUP_TABLE_TOLERANCE, relative to its magnitude, at the midpoint of every interval. Where
+// the function is near zero the relative bound gives way to the absolute LOOKUP_TABLE_FLOOR. A
+// function which cannot meet the bound, e.g. one which is not finite somewhere in the range, is
+// left without a table and is always evaluated exactly, as are values outside the range.
+// Copyright 2010 Simatra Modeling Technologies, L.L.C.
+
+#define LOOKUP_TABLE_MIN_SIZE 64
+#define LOOKUP_TABLE_MAX_SIZE (1<<20)
+
+lookup_table lookup_tables[NUM_LOOKUP_TABLES];
+
+static void lookup_table_build(lookup_table *table, CDATAFORMAT low, CDATAFORMAT high, CDATAFORMAT (*f)(CDATAFORMAT)){
+  unsigned int size, i;
+  CDATAFORMAT h, mid, err;
+  CDATAFORMAT *values;
+  int within;
+
+  table->low = low;
+  table->high = high;
+  table->values = NULL;
+
+  if(!(high > low))
+    return;
+
+  for(size = LOOKUP_TABLE_MIN_SIZE; size <= LOOKUP_TABLE_MAX_SIZE; size *= 2){
+    values = (CDATAFORMAT *)malloc((size + 1) * sizeof(CDATAFORMAT));
+    if(!values)
+      return;
+    h = (high - low) / size;
+    for(i=0;i<=size;i++){
+      values[i] = f(low + i * h);
+    }
+    within = 1;
+    for(i=0;i<size && within;i++){
+      mid = f(low + (i + 0.5) * h);
+      err = fabs(mid - 0.5 * (values[i] + values[i+1]));
+      // Comparison fails for non-finite values
+      within = err <= MAX(LOOKUP_TABLE_TOLERANCE * fabs(mid), LOOKUP_TABLE_FLOOR);
+    }
+    if(within){
+      table->size = size;
+      table->scale = size / (high - low);
+      table->values = values;
+      return;
+    }
+    free(values);
+  }
+}
+
+static void lookup_tables_free(void){
+  unsigned int i;
+  for(i=0;i<NUM_LOOKUP_TABLES;i++){
+    free(lookup_tables[i].values);
+    lookup_tables[i].values = NULL;
+  }
+}
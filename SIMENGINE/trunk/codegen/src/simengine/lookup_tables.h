@@ -0,0 +1,24 @@
+// Interpolation of the lookup tables by the flows, see lookup_tables.c for their construction.
+// Copyright 2010 Simatra Modeling Technologies, L.L.C.
+
+typedef struct {
+  CDATAFORMAT low;
+  CDATAFORMAT high;
+  CDATAFORMAT scale; // Intervals per unit of the state
+  unsigned int size; // Number of intervals
+  CDATAFORMAT *values; // size+1 samples, NULL if the function is not tabulated
+} lookup_table;
+
+extern lookup_table lookup_tables[NUM_LOOKUP_TABLES];
+
+static inline CDATAFORMAT lookup_table_interp(const lookup_table *table, CDATAFORMAT x){
+  CDATAFORMAT pos = (x - table->low) * table->scale;
+  unsigned int i = (unsigned int)pos;
+  if(i >= table->size)
+    i = table->size - 1;
+  pos -= i;
+  return table->values[i] + pos * (table->values[i+1] - table->values[i]);
+}
+
+// Evaluates to the interpolated value of table id at x, or to exact when x is not covered
+#define LOOKUP_TABLE(id, x, exact) ((NULL != lookup_tables[id].values && (x) >= lookup_tables[id].low && (x) <= lookup_tables[id].high) ? lookup_table_interp(&lookup_tables[id], (x)) : (exact))
@@ -9,4 +9,4 @@
 #define __HOST__
 #define __GLOBAL__
 
-static const char target[] = "parallelcpu";
+#define TARGET_NAME "parallelcpu"
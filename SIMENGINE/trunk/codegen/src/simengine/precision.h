@@ -13,6 +13,15 @@ typedef double CDATAFORMAT;
 #error Must define a storage type (SIMENGINE_STORAGE_float or SIMENGINE_STORAGE_double)
 #endif
 
+// The type of the sums of solver stages.  Mixed precision stores quantities in single precision
+// but accumulates the stage sums of the solvers in double precision and advances time by
+// compensated summation, see solver_step_time().
+#if defined SIMENGINE_STORAGE_float && defined SIMENGINE_MIXED_PRECISION
+typedef double CDATAACCUM;
+#else
+typedef CDATAFORMAT CDATAACCUM;
+#endif
+
 #ifndef NAN
 #define NAN (FLITERAL(0.0)/FLITERAL(0.0))
 #else
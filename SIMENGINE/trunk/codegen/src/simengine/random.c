@@ -1,65 +1,49 @@
-/* A parallel implementation of the R250 PRNG.
+/* A counter-based parallel implementation of the Philox4x32-10 PRNG.
  *
- * Each random bit X is produced by the sum of 2 past bits
- *   X[k] = X[k-q] + K[k-p]
- * where q = 103 and p = 250. That is, a generalized feedback shift
- * register GFSR(250,103).
+ * Each random value is a pure function of a 64-bit key and a 128-bit
+ * counter. The key is formed from the user seed and the global model
+ * id, so every instance owns an independent stream regardless of
+ * batching, thread count, or --instance_offset sharding. The counter
+ * holds the number of draws already taken by the instance and a
+ * stream identifier distinguishing draws made while initializing
+ * states from those made by the flows.
  *
- * Uses 31 bits of entropy to produce a random value with a period of
- * 2 ** 249. This algorithm requires another source of randomness to
- * seed its buffer which retains the last 250 generated values.
+ * A round multiplies two of the four counter words by fixed odd
+ * constants and mixes the high and low halves of the products with
+ * the remaining words and the key. Ten rounds pass BigCrush.
  *
- * Based on a (buggy) public domain implementation by Michael Brundage.
+ * The only state retained per instance is its key and draw count, so
+ * seeding is a constant-time assignment rather than a serial fill of a
+ * history buffer.
  *
- * See http://www.taygeta.com/rwalks/node2.html
- * See http://www.qbrundage.com/michaelb/pubs/essays/random_number_generation.html
+ * See Salmon, Moraes, Dror and Shaw, "Parallel Random Numbers: As Easy
+ * as 1, 2, 3", SC11.
+ *
+ * Stream identifiers and the macros invoking the PRNG are in random.h.
  */
 /* Copyright (C) 2010 by Simatra Modeling Technologies, L.L.C. */
 
-#define R250_LENGTH 250
-#define R250_OFFSET 103
-#define R250_MAX RAND_MAX
-
-// An invalid data marker the same size as valid data.
-#ifdef SIMENGINE_STORAGE_float
-typedef unsigned int r250_invalid;
-const r250_invalid R250_INVALID = 0xFFFFFFFFUL;
-#else
-typedef unsigned long long r250_invalid;
-const r250_invalid R250_INVALID = 0xFFFFFFFFFFFFFFFFULL;
-#endif
-
-const unsigned char R250_INVALID_BYTE = 0xFF;
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
 
-#define R250_IS_VALID(ADDR) (R250_INVALID ^ *((r250_invalid *)(ADDR)))
-#define R250_INVALIDATE(ADDR) (*((r250_invalid *)(ADDR)) = R250_INVALID)
+// The seed shared by all instances
+unsigned int random_seed = 0;
 
-// The initial seed and memo of previously computed random values.
-__DEVICE__ unsigned int r250_buffer[PARALLEL_MODELS * R250_LENGTH];
-// Indexes into the above buffer.
-__DEVICE__ unsigned int r250_position[PARALLEL_MODELS];
-// Buffers intermediate results of computing a gaussian distribution.
-__DEVICE__ CDATAFORMAT gaussian_buffer[PARALLEL_MODELS];
+// Key words for each instance, formed from the seed and global model id.
+__DEVICE__ unsigned int random_key[PARALLEL_MODELS * 2];
+// Number of draws already taken by each instance.
+__DEVICE__ unsigned long long random_counter[PARALLEL_MODELS];
 #ifdef TARGET_GPU
 // Host memory copies of the above data.
-unsigned int h_r250_buffer[PARALLEL_MODELS * R250_LENGTH];
-unsigned int h_r250_position[PARALLEL_MODELS];
-CDATAFORMAT h_gaussian_buffer[PARALLEL_MODELS];
-#endif
-
-// Invokes the PRNG with the appropriate state addresses
-#define DEVICE_UNIFORM_RANDOM(N, I) (uniform_random(N, I, r250_buffer, r250_position))
-#define DEVICE_NORMAL_RANDOM(N, I) (gaussian_random(N, I, gaussian_buffer, r250_buffer, r250_position))
-#ifdef TARGET_GPU
-#define HOST_UNIFORM_RANDOM(N, I) (uniform_random(N, I, h_r250_buffer, h_r250_position))
-#define HOST_NORMAL_RANDOM(N, I) (gaussian_random(N, I, h_gaussian_buffer, h_r250_buffer, h_r250_position))
-#else
-#define HOST_UNIFORM_RANDOM DEVICE_UNIFORM_RANDOM
-#define HOST_NORMAL_RANDOM DEVICE_NORMAL_RANDOM
+unsigned int h_random_key[PARALLEL_MODELS * 2];
+unsigned long long h_random_counter[PARALLEL_MODELS];
 #endif
 
 void seed_entropy (unsigned int seed) {
-  srand(seed);
+  random_seed = seed;
 }
 
 void seed_entropy_with_time (void) {
@@ -67,77 +51,41 @@ void seed_entropy_with_time (void) {
   if (0 != gettimeofday(&tv, NULL)){
     ERROR(Simatra:PRNG, "Failed while getting current time: %s.", strerror(errno));
   }
-  seed_entropy(tv.tv_sec);
+  seed_entropy(tv.tv_sec ^ tv.tv_usec);
 }
 
-void random_init_instance (unsigned int instanceId, unsigned int *init_buffer) {
-  unsigned int maskA, maskB;
-  unsigned int pos;
-
-  maskA = 1;
-  maskB = R250_MAX;
-  pos = R250_LENGTH;
-
-  while (pos-- > 31) {
-    init_buffer[VEC_IDX(R250_LENGTH, pos, PARALLEL_MODELS, instanceId)] = rand();
-  }
-
-  // I believe my reference contained a bug in the following
-  // section by shifting in the opposite direction. 
-  // Additionally, the original seems to assume that rand()
-  // produces 32 bits of randomness when it only provides 31
-  // bits. -Josh
-
-  // Original author's comment: Establish linear independence of
-  // the bit columns by setting the diagonal bits and clearing
-  // all bits above.
-  while (pos-- > 0) {
-    init_buffer[VEC_IDX(R250_LENGTH, pos, PARALLEL_MODELS, instanceId)] = (rand() | maskA) & maskB;
-    maskB ^= maskA;
-    maskA <<= 1;
-  }
-  init_buffer[VEC_IDX(R250_LENGTH, 0, PARALLEL_MODELS, instanceId)] = 0;
-}
-
-void random_init (unsigned int instances) {
-  unsigned int *init_buffer;
-  unsigned int *init_position;
-  CDATAFORMAT *gaussian_init;
+// Keys each instance of a batch by the seed and its global model id.
+void random_init (unsigned int instances, unsigned int modelid_offset) {
+  unsigned int *init_key;
+  unsigned long long *init_counter;
 #ifdef TARGET_GPU
-  init_buffer = h_r250_buffer;
-  init_position = h_r250_position;
-  gaussian_init = h_gaussian_buffer;
+  init_key = h_random_key;
+  init_counter = h_random_counter;
 #else
-  init_buffer = r250_buffer;
-  init_position = r250_position;
-  gaussian_init = gaussian_buffer;
+  init_key = random_key;
+  init_counter = random_counter;
 #endif
 
   unsigned int i;
   for (i = 0; i < instances; i++) {
-    random_init_instance(i, init_buffer);
+    init_key[VEC_IDX(2, 0, PARALLEL_MODELS, i)] = random_seed;
+    init_key[VEC_IDX(2, 1, PARALLEL_MODELS, i)] = modelid_offset + i;
   }
 
-  memset(init_position, 0, PARALLEL_MODELS * sizeof(unsigned int));
-  // Cleverly fills the gaussian buffer with a pattern of bytes that
-  // will appear as an invalid value in floating point.
-  memset(gaussian_init, R250_INVALID_BYTE, PARALLEL_MODELS * sizeof(CDATAFORMAT));
+  memset(init_counter, 0, PARALLEL_MODELS * sizeof(unsigned long long));
 }
 
 // Copies the current state of the PRNG to device memory.
 // No op for CPU-based targets.
 void random_copy_state_to_device (void) {
 #ifdef TARGET_GPU
-  unsigned int *g_buffer;
-  unsigned int *g_position;
-  CDATAFORMAT *g_gaussian_buffer;
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_gaussian_buffer, gaussian_buffer));
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_position, r250_position));
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_buffer, r250_buffer));
-
-  cutilSafeCall(cudaMemcpy(g_buffer, h_r250_buffer, PARALLEL_MODELS * R250_LENGTH * sizeof(unsigned int), cudaMemcpyHostToDevice));
-  cutilSafeCall(cudaMemcpy(g_position, h_r250_position, PARALLEL_MODELS * sizeof(unsigned int), cudaMemcpyHostToDevice)); 
-  cutilSafeCall(cudaMemcpy(g_gaussian_buffer, h_gaussian_buffer, PARALLEL_MODELS * sizeof(CDATAFORMAT), cudaMemcpyHostToDevice));
+  unsigned int *g_key;
+  unsigned long long *g_counter;
+  cutilSafeCall(cudaGetSymbolAddress((void **)&g_key, random_key));
+  cutilSafeCall(cudaGetSymbolAddress((void **)&g_counter, random_counter));
+
+  cutilSafeCall(cudaMemcpy(g_key, h_random_key, PARALLEL_MODELS * 2 * sizeof(unsigned int), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemcpy(g_counter, h_random_counter, PARALLEL_MODELS * sizeof(unsigned long long), cudaMemcpyHostToDevice));
 #endif
 }
 
@@ -145,99 +93,113 @@ void random_copy_state_to_device (void) {
 // No op for CPU-based targets
 void random_copy_state_from_device (void) {
 #ifdef TARGET_GPU
-  unsigned int *g_buffer;
-  unsigned int *g_position;
-  CDATAFORMAT *g_gaussian_buffer;
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_gaussian_buffer, gaussian_buffer));
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_position, r250_position));
-  cutilSafeCall(cudaGetSymbolAddress((void **)&g_buffer, r250_buffer));
-
-  cutilSafeCall(cudaMemcpy(h_r250_buffer, g_buffer, PARALLEL_MODELS * R250_LENGTH * sizeof(unsigned int), cudaMemcpyDeviceToHost));
-  cutilSafeCall(cudaMemcpy(h_r250_position, g_position, PARALLEL_MODELS * sizeof(unsigned int), cudaMemcpyDeviceToHost)); 
-  cutilSafeCall(cudaMemcpy(h_gaussian_buffer, g_gaussian_buffer, PARALLEL_MODELS * sizeof(CDATAFORMAT), cudaMemcpyDeviceToHost));
+  unsigned int *g_key;
+  unsigned long long *g_counter;
+  cutilSafeCall(cudaGetSymbolAddress((void **)&g_key, random_key));
+  cutilSafeCall(cudaGetSymbolAddress((void **)&g_counter, random_counter));
+
+  cutilSafeCall(cudaMemcpy(h_random_key, g_key, PARALLEL_MODELS * 2 * sizeof(unsigned int), cudaMemcpyDeviceToHost));
+  cutilSafeCall(cudaMemcpy(h_random_counter, g_counter, PARALLEL_MODELS * sizeof(unsigned long long), cudaMemcpyDeviceToHost));
 #endif
 }
 
-// Returns a uniformly-distributed random number on the interval [0,1)
-__HOST__ __DEVICE__ CDATAFORMAT uniform_random (unsigned int instances, unsigned int instanceId, unsigned int *buffer, unsigned int *position) {
-  // My reference did some clever prescaling of buffer offsets which
-  // seemed to cause problems on the GPU. The justification for the
-  // cleverness was wrt optimizing for PPC, so I assume that it is
-  // not particularly optimal for GPU or x86. We use our
-  // target-agnostic parallel indexing macros. -Josh
-  unsigned int *tmp;
-  unsigned int r;
-  unsigned int i = position[instanceId];
-  int j = i - R250_OFFSET;
-  if (j < 0) j = j + R250_LENGTH;
-
-  tmp = buffer + VEC_IDX(R250_LENGTH, i, instances, instanceId);
-  r = buffer[VEC_IDX(R250_LENGTH, j, instances, instanceId)];
-  r = r ^ *tmp;
-  *tmp = r;
-
-  position[instanceId] += (i == R250_LENGTH - 1) ? -i : 1;
-    
-  return r / (FLITERAL(1.) * R250_MAX);
+// Computes the 128 random bits associated with a counter and key.
+// Contains no data dependent branches, so calls for different
+// instances vectorize across SIMD lanes and GPU threads alike.
+__HOST__ __DEVICE__ void philox4x32 (unsigned int counter[4], unsigned int key0, unsigned int key1, unsigned int out[4]) {
+  unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  unsigned int hi0, lo0, hi1, lo1;
+  unsigned long long product;
+  int round;
+
+  for (round = 0; round < PHILOX_ROUNDS; round++) {
+    product = (unsigned long long)PHILOX_M0 * c0;
+    hi0 = (unsigned int)(product >> 32);
+    lo0 = (unsigned int)product;
+    product = (unsigned long long)PHILOX_M1 * c2;
+    hi1 = (unsigned int)(product >> 32);
+    lo1 = (unsigned int)product;
+
+    c0 = hi1 ^ c1 ^ key0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ key1;
+    c3 = lo0;
+
+    key0 += PHILOX_W0;
+    key1 += PHILOX_W1;
+  }
+
+  out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
 }
 
-// We previously relied on the gaussian transform implemented below, which was shown to be slower both on the CPU and the GPU than Box Muller,
-// although the discrepancy is much more profound on the GPU
-//#define gaussian_random gaussian_transform
-#define gaussian_random box_muller_transform
+// Takes the next 128 random bits for an instance from a given stream.
+__HOST__ __DEVICE__ void random_block (unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream, unsigned int out[4]) {
+  unsigned long long draw = counter[instanceId]++;
+  unsigned int ctr[4];
 
-// Returns a normally-distributed random number centered at 0 on the interval (-Inf, Inf)
-__HOST__ __DEVICE__ CDATAFORMAT gaussian_transform (unsigned int instances, unsigned int instanceId, CDATAFORMAT *buffer, unsigned int *ubuffer, unsigned int *uposition) {
-  CDATAFORMAT grandom = buffer[instanceId];
-  CDATAFORMAT x1, x2;
-  CDATAFORMAT w;
-
-  if (R250_IS_VALID(&grandom)) {
-    // Return the previously-computed value and invalidate the
-    // stored buffer.
-    R250_INVALIDATE(buffer + instanceId);
-  }
-  else {
-    // Compute 2 new values and hold one
-    w = FLITERAL(1.);
-    do {
-      x1 = 2 * uniform_random(instances, instanceId, ubuffer, uposition) - 1;
-      x2 = 2 * uniform_random(instances, instanceId, ubuffer, uposition) - 1;
-      w = x1 * x1 + x2 * x2;
-    } while (w >= FLITERAL(1.));
-
-    w = pow(FLITERAL(-2.) * log(w) / w, FLITERAL(0.5));
-    grandom = x1 * w;
-    buffer[instanceId] = x2 * w;
-  }
+  ctr[0] = (unsigned int)draw;
+  ctr[1] = (unsigned int)(draw >> 32);
+  ctr[2] = stream;
+  ctr[3] = 0;
 
-  return grandom;
+  philox4x32(ctr, key[VEC_IDX(2, 0, instances, instanceId)], key[VEC_IDX(2, 1, instances, instanceId)], out);
 }
 
+// Converts random bits to a uniformly-distributed value on the interval [0,1)
+// using the full precision of the storage type.
+#ifdef SIMENGINE_STORAGE_float
+#define BITS_TO_UNIFORM(W0, W1) (((W0) >> 8) * (1.0f / 16777216.0f))
+#else
+#define BITS_TO_UNIFORM(W0, W1) ((((W0) >> 5) * 67108864.0 + ((W1) >> 6)) * (1.0 / 9007199254740992.0))
+#endif
+
+// Returns a uniformly-distributed random number on the interval [0,1)
+__HOST__ __DEVICE__ CDATAFORMAT uniform_random (unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream) {
+  unsigned int bits[4];
+
+  random_block(instances, instanceId, key, counter, stream, bits);
+
+  return BITS_TO_UNIFORM(bits[0], bits[1]);
+}
 
 // Returns a normally-distributed random number centered at 0 on the interval (-Inf, Inf)
-__HOST__ __DEVICE__ CDATAFORMAT box_muller_transform(unsigned int instances, unsigned int instanceId, CDATAFORMAT *buffer, unsigned int *ubuffer, unsigned int *uposition){
-  CDATAFORMAT grandom = buffer[instanceId];
+// Both uniform deviates of the Box-Muller transform come from a single block, so no
+// intermediate results need to be retained between calls.
+__HOST__ __DEVICE__ CDATAFORMAT box_muller_transform(unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream){
+  unsigned int bits[4];
   CDATAFORMAT u0, u1;
   CDATAFORMAT r;
   CDATAFORMAT theta;
   const CDATAFORMAT PI = FLITERAL(3.14159265358979323846);
 
-  if(R250_IS_VALID(&grandom)){
-    // Return the previously-computed value and invalidate the
-    // stored buffer.
-    R250_INVALIDATE(buffer + instanceId);
-  }
-  else{
-    // Compute 2 new values and hold one
-    u0 = uniform_random(instances, instanceId, ubuffer, uposition);
-    u1 = uniform_random(instances, instanceId, ubuffer, uposition);
-    r = sqrt(FLITERAL(-2.0) * log(u0));
-    theta = FLITERAL(2.0)*PI*u1;
-
-    grandom = r*sin(theta);
-    buffer[instanceId] = r*cos(theta);
-  }
+  random_block(instances, instanceId, key, counter, stream, bits);
+
+  // u0 lies on (0,1] to keep the logarithm finite
+  u0 = FLITERAL(1.0) - BITS_TO_UNIFORM(bits[0], bits[1]);
+  u1 = BITS_TO_UNIFORM(bits[2], bits[3]);
+  r = sqrt(FLITERAL(-2.0) * log(u0));
+  theta = FLITERAL(2.0)*PI*u1;
+
+  return r*sin(theta);
+}
+
+// Writes two independent normally-distributed random numbers to z, taking both the sine and
+// cosine branches of the Box-Muller transform from a single block.  Used when many deviates
+// are drawn at once, e.g. the Wiener increments of every state in a stochastic solver step.
+__HOST__ __DEVICE__ void box_muller_transform_pair(unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream, CDATAFORMAT z[2]){
+  unsigned int bits[4];
+  CDATAFORMAT u0, u1;
+  CDATAFORMAT r;
+  CDATAFORMAT theta;
+  const CDATAFORMAT PI = FLITERAL(3.14159265358979323846);
+
+  random_block(instances, instanceId, key, counter, stream, bits);
+
+  u0 = FLITERAL(1.0) - BITS_TO_UNIFORM(bits[0], bits[1]);
+  u1 = BITS_TO_UNIFORM(bits[2], bits[3]);
+  r = sqrt(FLITERAL(-2.0) * log(u0));
+  theta = FLITERAL(2.0)*PI*u1;
 
-  return grandom;
+  z[0] = r*sin(theta);
+  z[1] = r*cos(theta);
 }
@@ -0,0 +1,39 @@
+/* Declarations of the PRNG state and functions referenced by the flows.
+ *
+ * The flows of the CPU targets may be compiled in units apart from the
+ * runtime, see random.c for the definitions.
+ */
+/* Copyright (C) 2010 by Simatra Modeling Technologies, L.L.C. */
+
+// Stream identifiers occupy the third counter word
+#define RANDOM_STREAM_DEVICE 0
+#define RANDOM_STREAM_HOST 1
+
+#ifndef TARGET_GPU
+// The GPU target is always compiled as a single unit and has no use for external declarations.
+extern unsigned int random_key[PARALLEL_MODELS * 2];
+extern unsigned long long random_counter[PARALLEL_MODELS];
+// Scale of the wiener() white noise terms, see solvers.h
+extern CDATAFORMAT wiener_scale[PARALLEL_MODELS];
+#endif
+
+__HOST__ __DEVICE__ CDATAFORMAT uniform_random (unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream);
+__HOST__ __DEVICE__ CDATAFORMAT box_muller_transform(unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream);
+__HOST__ __DEVICE__ void box_muller_transform_pair(unsigned int instances, unsigned int instanceId, unsigned int *key, unsigned long long *counter, unsigned int stream, CDATAFORMAT z[2]);
+
+#define gaussian_random box_muller_transform
+#define gaussian_random_pair box_muller_transform_pair
+
+// Invokes the PRNG with the appropriate state addresses
+#define DEVICE_UNIFORM_RANDOM(N, I) (uniform_random(N, I, random_key, random_counter, RANDOM_STREAM_DEVICE))
+#define DEVICE_NORMAL_RANDOM(N, I) (gaussian_random(N, I, random_key, random_counter, RANDOM_STREAM_DEVICE))
+#define DEVICE_NORMAL_RANDOM_PAIR(N, I, Z) (gaussian_random_pair(N, I, random_key, random_counter, RANDOM_STREAM_DEVICE, Z))
+#ifdef TARGET_GPU
+#define HOST_UNIFORM_RANDOM(N, I) (uniform_random(N, I, h_random_key, h_random_counter, RANDOM_STREAM_HOST))
+#define HOST_NORMAL_RANDOM(N, I) (gaussian_random(N, I, h_random_key, h_random_counter, RANDOM_STREAM_HOST))
+#else
+#define HOST_UNIFORM_RANDOM(N, I) (uniform_random(N, I, random_key, random_counter, RANDOM_STREAM_HOST))
+#define HOST_NORMAL_RANDOM(N, I) (gaussian_random(N, I, random_key, random_counter, RANDOM_STREAM_HOST))
+#endif
+
+#define WIENER_NOISE(N, I) (wiener_scale[(I)])
@@ -1,6 +1,6 @@
 const simengine_interface seint = {
   model_name,
-  target,
+  TARGET_NAME,
   solver_names,
   iterator_names,
   input_names,
@@ -21,6 +21,14 @@ static const struct option long_options[] = {
   {"buffer_count", required_argument, 0, BUFFER_COUNT},
   {"max_iterations", required_argument, 0, MAX_ITERS},
   {"gpu_block_size", required_argument, 0, GPU_BLOCK_SZ},
+#ifdef TARGET_OPENMP
+  {"parareal", required_argument, 0, PARAREAL},
+  {"parareal_tolerance", required_argument, 0, PARAREAL_TOL},
+#endif
+#if !defined TARGET_GPU
+  {"steady_state", required_argument, 0, STEADY_STATE},
+  {"steady_state_newton", no_argument, 0, STEADY_STATE_NEWTON_OPT},
+#endif
   // HACK BEGIN
   {"all_timesteps", required_argument, 0, ALL_TIMESTEPS},
   // HACK END
@@ -33,6 +41,18 @@ static int simex_output_files = 1;
 static unsigned int global_modelid_offset = 0;
 static unsigned int MAX_ITERATIONS = 100;
 static unsigned int GPU_BLOCK_SIZE = 128;
+#ifdef TARGET_OPENMP
+// Number of time slices integrated in parallel for a single instance, 0 when disabled
+static unsigned int PARAREAL_SLICES = 0;
+static double PARAREAL_TOLERANCE = 1e-6;
+#endif
+#if !defined TARGET_GPU
+// Number of consecutive settled steps after which an instance is stopped at steady state, 0 when disabled
+static unsigned int STEADY_STATE_WINDOW = 0;
+static int STEADY_STATE_NEWTON = 0;
+// Time of convergence of each instance in the current batch
+static double steady_state_time[PARALLEL_MODELS];
+#endif
 
 double global_timestep = 0.0;
 unsigned int global_ob_count = 2;
@@ -163,7 +183,6 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
   int output_fd;
 
   int resuming = 0;
-  int random_initialized = 0;
 
 # if defined TARGET_GPU
   gpu_init();
@@ -184,16 +203,25 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
     seresult->final_states = NULL;
   }
   seresult->final_time = (double*)malloc(num_models * sizeof(double));
-  if((seint.num_states && !seresult->final_states) ||!seresult->final_time){
+  seresult->solver_stats = (double*)malloc(num_models * seint.num_iterators * NUM_SOLVER_STATS * sizeof(double));
+  seresult->steady_time = (double*)malloc(num_models * sizeof(double));
+  if((seint.num_states && !seresult->final_states) ||!seresult->final_time || !seresult->solver_stats || !seresult->steady_time){
     seresult->status = ERRMEM;
     seresult->status_message = (char*) simengine_errors[ERRMEM];
     seresult->final_states = NULL;
     seresult->final_time = NULL;
+    seresult->solver_stats = NULL;
+    seresult->steady_time = NULL;
     return seresult;
   }
 
   init_output_buffers(outputs_dirname, &output_fd);
 
+#if NUM_LOOKUP_TABLES > 0
+  // Tables of expensive functions of a single state are shared by all model instances
+  init_lookup_tables();
+#endif
+
   // Run the parallel simulation repeatedly until all requested models have been executed
   for(models_executed = 0 ; models_executed < num_models; models_executed += PARALLEL_MODELS){
     models_per_batch = MIN(num_models - models_executed, PARALLEL_MODELS);
@@ -235,14 +263,29 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
     cutilSafeCall(cudaMemcpy(g_sampled_inputs, host_sampled_inputs, STRUCT_SIZE * NUM_SAMPLED_INPUTS * sizeof(sampled_input_t), cudaMemcpyHostToDevice));
 #endif
 
+#if NUM_PRECOMPUTED > 0
+    // Evaluate the expressions depending only on constant inputs once for each instance
+#if defined TARGET_GPU
+    host_precomputed_values = (CDATAFORMAT *)malloc(PARALLEL_MODELS * NUM_PRECOMPUTED * sizeof(CDATAFORMAT));
+#else
+    host_precomputed_values = precomputed_values;
+#endif
+    for(modelid=0; modelid<models_per_batch; modelid++){
+      precompute_instance(host_precomputed_values, modelid);
+    }
+#if defined TARGET_GPU
+    CDATAFORMAT *g_precomputed_values;
+    cutilSafeCall(cudaGetSymbolAddress((void **)&g_precomputed_values, precomputed_values));
+    cutilSafeCall(cudaMemcpy(g_precomputed_values, host_precomputed_values, PARALLEL_MODELS * NUM_PRECOMPUTED * sizeof(CDATAFORMAT), cudaMemcpyHostToDevice));
+    free(host_precomputed_values);
+#endif
+#endif
+
     // Initialize the solver properties and internal simulation memory structures
     solver_props *props = init_solver_props(start_time, stop_time, models_per_batch, model_states, models_executed+global_modelid_offset);
 
     // Initialize random number generator
-    if (!random_initialized || opts->seeded) {
-      random_init(models_per_batch);
-      random_initialized = 1;
-    }
+    random_init(models_per_batch, modelid_offset);
 
     // If no initial states were passed in
     if(!resuming){
@@ -259,6 +302,12 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
       }
     }
 
+#if !defined TARGET_GPU
+    for(modelid=0; modelid<models_per_batch; modelid++){
+      steady_state_time[modelid] = NAN;
+    }
+#endif
+
     // Run the model
     seresult->status = exec_loop(props, outputs_dirname, progress + models_executed, resuming);
     seresult->status_message = (char*) simengine_errors[seresult->status];
@@ -266,6 +315,22 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
     // Copy the final time from simulation
     for(modelid=0; modelid<models_per_batch; modelid++){
       seresult->final_time[models_executed + modelid] = props->time[modelid]; // Time from the first solver
+#if !defined TARGET_GPU
+      seresult->steady_time[models_executed + modelid] = steady_state_time[modelid];
+#else
+      seresult->steady_time[models_executed + modelid] = NAN;
+#endif
+    }
+
+    // Copy the solver statistics of each iterator
+    for(modelid=0; modelid<models_per_batch; modelid++){
+      unsigned int iterid;
+      for(iterid=0;iterid<seint.num_iterators;iterid++){
+	double *stats = seresult->solver_stats + ((models_executed + modelid) * seint.num_iterators + iterid) * NUM_SOLVER_STATS;
+	stats[0] = props[iterid].stats[modelid].accepted;
+	stats[1] = props[iterid].stats[modelid].rejected;
+	stats[2] = props[iterid].stats[modelid].flows;
+      }
     }
 
     // Free all internal simulation memory and make sure that model_states has the final state values
@@ -280,6 +345,9 @@ simengine_result *simengine_runmodel(simengine_opts *opts){
   }
 
   free(model_states);
+#if NUM_LOOKUP_TABLES > 0
+  lookup_tables_free();
+#endif
 
   close_progress_file(progress, progress_fd, num_models);
   clean_up_output_buffers(output_fd);
@@ -508,6 +576,31 @@ int parse_args(int argc, char **argv, simengine_opts *opts){
 	USER_ERROR(Simatra:Simex:parse_args, "Invalid gpu block size %d", GPU_BLOCK_SIZE);
       }            
       break;
+#ifdef TARGET_OPENMP
+    case PARAREAL:
+      PARAREAL_SLICES = (unsigned int)strtod(optarg, NULL); // Handles 1E3 etc.
+      if(PARAREAL_SLICES < 1 || PARAREAL_SLICES > PARALLEL_MODELS){
+	USER_ERROR(Simatra:Simex:parse_args, "Invalid number of parareal time slices %d, must be between 1 and %d", PARAREAL_SLICES, PARALLEL_MODELS);
+      }
+      break;
+    case PARAREAL_TOL:
+      PARAREAL_TOLERANCE = strtod(optarg, NULL);
+      if(PARAREAL_TOLERANCE <= 0){
+	USER_ERROR(Simatra:Simex:parse_args, "Invalid parareal tolerance %g", PARAREAL_TOLERANCE);
+      }
+      break;
+#endif
+#if !defined TARGET_GPU
+    case STEADY_STATE:
+      STEADY_STATE_WINDOW = (unsigned int)strtod(optarg, NULL); // Handles 1E3 etc.
+      if(STEADY_STATE_WINDOW < 1){
+	USER_ERROR(Simatra:Simex:parse_args, "Invalid steady state window %d", STEADY_STATE_WINDOW);
+      }
+      break;
+    case STEADY_STATE_NEWTON_OPT:
+      STEADY_STATE_NEWTON = 1;
+      break;
+#endif
       // HACK BEGIN
     case ALL_TIMESTEPS:
       global_timestep = strtod(optarg, NULL);
@@ -648,6 +741,40 @@ void write_states_time(simengine_opts *opts, simengine_result *result){
     ERROR(Simatra::Simex::write_states_time, "could not write to file '%s'", states_time_filename);
   }
   fclose(states_time_file);
+
+  // Write solver statistics
+  position = global_modelid_offset * seint.num_iterators * NUM_SOLVER_STATS * sizeof(double);
+  sprintf(states_time_filename, "%s/solver-stats", opts->outputs_dirname);
+  states_time_file = fopen(states_time_filename, "w");
+  if(NULL == states_time_file){
+    ERROR(Simatra::Simex::write_states_time, "could not open file '%s'", states_time_filename);
+  }
+  if(-1 == fseek(states_time_file, position, SEEK_SET)){
+    ERROR(Simatra::Simex::write_states_time, "could not seek to position %ld in file '%s'", position, states_time_filename);
+  }
+  if(opts->num_models * seint.num_iterators * NUM_SOLVER_STATS != fwrite(result->solver_stats, sizeof(double), opts->num_models * seint.num_iterators * NUM_SOLVER_STATS, states_time_file)){
+    ERROR(Simatra::Simex::write_states_time, "could not write to file '%s'", states_time_filename);
+  }
+  fclose(states_time_file);
+
+#if !defined TARGET_GPU
+  // Write the time at which each model reached steady state
+  if(STEADY_STATE_WINDOW){
+    position = global_modelid_offset * sizeof(double);
+    sprintf(states_time_filename, "%s/steady-time", opts->outputs_dirname);
+    states_time_file = fopen(states_time_filename, "w");
+    if(NULL == states_time_file){
+      ERROR(Simatra::Simex::write_states_time, "could not open file '%s'", states_time_filename);
+    }
+    if(-1 == fseek(states_time_file, position, SEEK_SET)){
+      ERROR(Simatra::Simex::write_states_time, "could not seek to position %ld in file '%s'", position, states_time_filename);
+    }
+    if(opts->num_models != fwrite(result->steady_time, sizeof(double), opts->num_models, states_time_file)){
+      ERROR(Simatra::Simex::write_states_time, "could not write to file '%s'", states_time_filename);
+    }
+    fclose(states_time_file);
+  }
+#endif
 }
 
 #include<signal.h>
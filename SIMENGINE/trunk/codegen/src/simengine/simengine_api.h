@@ -80,8 +80,13 @@ typedef struct{
   char *status_message;
   double *final_states;
   double *final_time;
+  double *solver_stats; // Steps accepted, steps rejected and flow evaluations of each iterator of each model
+  double *steady_time; // Time at which each model reached steady state, NaN if it did not
 } simengine_result;
 
+// Number of solver statistics per iterator
+#define NUM_SOLVER_STATS 3
+
 // Options parsed from the commandline
 typedef struct{
   int seeded;
@@ -115,6 +120,14 @@ typedef enum {
   BUFFER_COUNT,
   MAX_ITERS,
   GPU_BLOCK_SZ,
+#ifdef TARGET_OPENMP
+  PARAREAL,
+  PARAREAL_TOL,
+#endif
+#if !defined TARGET_GPU
+  STEADY_STATE,
+  STEADY_STATE_NEWTON_OPT,
+#endif
   ALL_TIMESTEPS,
   HELP
 } clopts;
@@ -144,6 +157,16 @@ typedef enum {
 #define MAX(X, Y) ((X) > (Y) ? (X) : (Y))
 #endif
 
+// Fused multiply add, written by the relaxed precision mode.  The library function is only
+// used where the hardware provides it; elsewhere it is much slower than the separate operations.
+#if defined SIMENGINE_STORAGE_float && (defined TARGET_GPU || defined FP_FAST_FMAF)
+#define FMA(A, B, C) fmaf(A, B, C)
+#elif defined SIMENGINE_STORAGE_double && (defined TARGET_GPU || defined FP_FAST_FMA)
+#define FMA(A, B, C) fma(A, B, C)
+#else
+#define FMA(A, B, C) ((A) * (B) + (C))
+#endif
+
 #ifndef NAN
 #define NAN (FLITERAL(0.0)/FLITERAL(0.0))
 #endif
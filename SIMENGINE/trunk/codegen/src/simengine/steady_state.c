@@ -0,0 +1,132 @@
+// Steady state detection for a single model instance.
+//
+// After every step the rate of change of the states, (y[t+dt] - y[t])/dt, is measured in the
+// weighted RMS norm of the solver tolerances, each state scaled by abstol + reltol*|y|.  Once the
+// norm has stayed within one for a window of consecutive steps the instance is stopped early, its
+// final outputs are captured as at the stop time and the time of convergence is recorded.
+// Optionally the fixed point is then polished by Newton iterations on the flows of each
+// continuous iterator, keeping the integrated states if the iteration does not reduce the
+// residual.
+// Copyright 2010 Simatra Modeling Technologies, L.L.C.
+
+// Tolerances used for iterators whose solvers have none, i.e. the fixed step solvers
+#define STEADY_STATE_ABSTOL 1e-6
+#define STEADY_STATE_RELTOL 1e-3
+
+#define STEADY_STATE_NEWTON_ITERATIONS 8
+#define STEADY_STATE_NEWTON_TOLERANCE 1e-6
+
+// Weight of a state value in the steady state norm
+static CDATAFORMAT steady_state_scale(solver_props *props, CDATAFORMAT y){
+  if(0 == props->abstol && 0 == props->reltol)
+    return STEADY_STATE_ABSTOL + STEADY_STATE_RELTOL * fabs(y);
+  return props->abstol + props->reltol * fabs(y);
+}
+
+// Returns nonzero if the step just taken from model_states to next_states changed the states at
+// a rate within the tolerances.
+static int steady_state_settled(solver_props *props, unsigned int modelid){
+  int i;
+  CDATAFORMAT h = props->next_time[modelid] - props->time[modelid];
+  CDATAFORMAT rate, err_sum = 0;
+
+  if(0 == props->statesize)
+    return 1;
+  // A rejected step of an adaptive solver leaves the time unchanged and says nothing of the rate
+  if(h <= 0)
+    return 0;
+
+  for(i=props->statesize-1; i>=0; i--) {
+    rate = (props->next_states[STATE_IDX] - props->model_states[STATE_IDX]) / (h * steady_state_scale(props, props->next_states[STATE_IDX]));
+    err_sum += rate * rate;
+  }
+
+  return sqrt(err_sum / props->statesize) <= 1;
+}
+
+// Weighted RMS norm of the flows at the current states
+static CDATAFORMAT steady_state_residual(solver_props *props, CDATAFORMAT *dydt, unsigned int modelid){
+  int i;
+  CDATAFORMAT err, err_sum = 0;
+
+  for(i=props->statesize-1; i>=0; i--) {
+    err = dydt[STATE_IDX] / steady_state_scale(props, props->model_states[STATE_IDX]);
+    err_sum += err * err;
+  }
+
+  return sqrt(err_sum / props->statesize);
+}
+
+// Solves flows(y) = 0 from the current states by Newton's method with a forward difference
+// Jacobian, sharing the linear algebra of the Rosenbrock solvers.
+static int steady_state_newton(solver_props *props, unsigned int modelid){
+  rosenbrock_work *work;
+  CDATAFORMAT *saved, *delta;
+  CDATAFORMAT initial, residual;
+  CDATAFORMAT t = props->time[modelid];
+  unsigned int iter;
+  int i;
+  int ret = 0;
+
+  if(0 == props->statesize)
+    return 0;
+
+  work = rosenbrock_work_init(props);
+  // The first stage vector is overwritten by the Jacobian evaluation
+  saved = work->k + props->statesize * PARALLEL_MODELS;
+  delta = work->temp;
+
+  for(i=props->statesize-1; i>=0; i--) {
+    saved[STATE_IDX] = props->model_states[STATE_IDX];
+  }
+
+  ret |= model_flows(t, props->model_states, work->f0, props, 0, modelid);
+  initial = residual = steady_state_residual(props, work->f0, modelid);
+
+  for(iter=0; iter<STEADY_STATE_NEWTON_ITERATIONS && !ret && residual > STEADY_STATE_NEWTON_TOLERANCE; iter++){
+    ret |= rosenbrock_jacobian(props, work, modelid);
+    // Factors -J, so that solving with the flows gives the Newton correction
+    if(rosenbrock_factor(props, work, 0, modelid))
+      break;
+    for(i=props->statesize-1; i>=0; i--) {
+      delta[STATE_IDX] = work->f0[STATE_IDX];
+    }
+    rosenbrock_solve(props, work, delta, modelid);
+    for(i=props->statesize-1; i>=0; i--) {
+      props->model_states[STATE_IDX] += delta[STATE_IDX];
+    }
+    ret |= model_flows(t, props->model_states, work->f0, props, 0, modelid);
+    residual = steady_state_residual(props, work->f0, modelid);
+  }
+
+  // Keep the integrated states if the iteration failed or diverged
+  if(ret || !(residual < initial)){
+    for(i=props->statesize-1; i>=0; i--) {
+      props->model_states[STATE_IDX] = saved[STATE_IDX];
+    }
+  }
+
+  rosenbrock_work_free(work);
+
+  return ret;
+}
+
+// Stops all iterators of an instance at steady state such that the outputs of the final
+// iteration are captured, and records the time of convergence.
+static void steady_state_stop(solver_props *props, unsigned int modelid){
+  unsigned int i;
+
+  for(i=0;i<NUM_ITERATORS;i++){
+    if(!props[i].running[modelid])
+      continue;
+    if(STEADY_STATE_NEWTON && solver_continuous(&props[i])){
+      if(0 != steady_state_newton(&props[i], modelid)){
+	WARN(Simatra:Simex:steady_state, "Newton iteration for the steady state of model %d failed, keeping the integrated states.\n", props->modelid_offset + modelid);
+      }
+    }
+    props[i].running[modelid] = 0;
+    props[i].last_iteration[modelid] = 1;
+  }
+
+  steady_state_time[modelid] = props->time[modelid]; // Time from the first solver
+}
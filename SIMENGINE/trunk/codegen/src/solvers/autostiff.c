@@ -0,0 +1,286 @@
+// Automatic Stiffness Switching Integration Method
+// Variable timestep solver which follows each instance with the explicit Dormand-Prince (4,5)
+// pair while its solution is nonstiff and with the Ros3 Rosenbrock method while it is stiff,
+// in the manner of LSODA.  Instances switch independently at run time, so a batch may hold
+// both kinds of steps at once and a spike within one instance does not force an implicit
+// method on the whole simulation.
+//
+// While explicit, the product h*lambda of the step and the dominant eigenvalue is estimated
+// from the two Dormand-Prince stages evaluated at the end of each step (Hairer and Wanner,
+// "Solving Ordinary Differential Equations II", IV.2).  Steps, accepted or rejected, for which
+// the product lies outside the stability region count toward a switch to the implicit method.
+// While implicit, the spectral radius of the Jacobian is estimated by power iteration, and
+// steps at which the explicit method would be stable at the current step size count toward a
+// switch back.
+// Copyright 2009, 2010 Simatra Modeling Technologies, L.L.C.
+
+// Dormand-Prince stages
+#define AUTOSTIFF_STAGES 7
+// Bound on |h*lambda| of the stability region of the Dormand-Prince method along the
+// negative real axis
+#define AUTOSTIFF_STABILITY_BOUND 3.25
+// Steps of evidence required before switching methods
+#define AUTOSTIFF_SWITCH_STEPS 15
+// Consecutive steps of contrary evidence which discard the evidence gathered so far
+#define AUTOSTIFF_RESET_STEPS 6
+
+typedef struct {
+  CDATAFORMAT *k; // Dormand-Prince stage vectors, AUTOSTIFF_STAGES consecutive state arrays
+  CDATAFORMAT *temp;
+  rosenbrock_work *work;
+  CDATAFORMAT *cur_timestep;
+  CDATAFORMAT *prev_norm; // Error norm of the previous accepted step, zero before the first
+  unsigned int *stiff; // Nonzero while an instance uses the implicit method
+  unsigned int *switch_count; // Steps suggesting the other method
+  unsigned int *reset_count; // Consecutive steps suggesting the current method
+} autostiff_mem;
+
+__HOST__
+int autostiff_init(solver_props *props){
+  unsigned int i;
+#if defined TARGET_GPU
+  // Temporary CPU copies of GPU datastructures
+  autostiff_mem tmem;
+  // GPU datastructures
+  autostiff_mem *dmem;
+
+  CDATAFORMAT *temp_cur_timestep;
+
+  // Allocate GPU space for mem and pointer fields of mem (other than props)
+  cutilSafeCall(cudaMalloc((void**)&dmem, sizeof(autostiff_mem)));
+  props->mem = dmem;
+  cutilSafeCall(cudaMalloc((void**)&tmem.k, AUTOSTIFF_STAGES*props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.temp, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  tmem.work = rosenbrock_work_init(props);
+  cutilSafeCall(cudaMalloc((void**)&tmem.cur_timestep, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.prev_norm, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.stiff, PARALLEL_MODELS*sizeof(unsigned int)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.switch_count, PARALLEL_MODELS*sizeof(unsigned int)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.reset_count, PARALLEL_MODELS*sizeof(unsigned int)));
+
+  // Create a local copy of the initial timestep and initialize
+  temp_cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  for(i=0; i<props->num_models; i++)
+    temp_cur_timestep[i] = props->timestep;
+
+  // Copy mem structure to GPU
+  cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(autostiff_mem), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemcpy(tmem.cur_timestep, temp_cur_timestep, props->num_models*sizeof(CDATAFORMAT), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemset(tmem.prev_norm, 0, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  // Every instance begins with the explicit method
+  cutilSafeCall(cudaMemset(tmem.stiff, 0, PARALLEL_MODELS*sizeof(unsigned int)));
+  cutilSafeCall(cudaMemset(tmem.switch_count, 0, PARALLEL_MODELS*sizeof(unsigned int)));
+  cutilSafeCall(cudaMemset(tmem.reset_count, 0, PARALLEL_MODELS*sizeof(unsigned int)));
+
+  // Free temporary
+  free(temp_cur_timestep);
+
+#else // Used for CPU and OPENMP targets
+
+  autostiff_mem *mem = (autostiff_mem*)malloc(sizeof(autostiff_mem));
+
+  props->mem = mem;
+  mem->k = (CDATAFORMAT*)malloc(AUTOSTIFF_STAGES*props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->temp = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->work = rosenbrock_work_init(props);
+
+  // Allocate and initialize timesteps
+  mem->cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  for(i=0; i<props->num_models; i++)
+    mem->cur_timestep[i] = props->timestep;
+  mem->prev_norm = (CDATAFORMAT*)calloc(PARALLEL_MODELS, sizeof(CDATAFORMAT));
+
+  // Every instance begins with the explicit method
+  mem->stiff = (unsigned int*)calloc(PARALLEL_MODELS, sizeof(unsigned int));
+  mem->switch_count = (unsigned int*)calloc(PARALLEL_MODELS, sizeof(unsigned int));
+  mem->reset_count = (unsigned int*)calloc(PARALLEL_MODELS, sizeof(unsigned int));
+#endif
+
+  return 0;
+}
+
+// Takes a single Dormand-Prince step of size h from props->model_states into props->next_states.
+// The flows at the beginning of the step must already be held in the first stage.  The weighted
+// RMS norm of the error estimate is written to norm and the estimate of |h*lambda| to hlambda.
+__DEVICE__
+int autostiff_explicit_step(solver_props *props, autostiff_mem *mem, CDATAFORMAT h, CDATAFORMAT *norm, CDATAFORMAT *hlambda, unsigned int modelid){
+  const CDATAFORMAT c[AUTOSTIFF_STAGES] = {0, 1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0};
+  // Stage coefficients, packed lower triangle
+  const CDATAFORMAT a[AUTOSTIFF_STAGES*(AUTOSTIFF_STAGES-1)/2] =
+    {1.0/5.0,
+     3.0/40.0, 9.0/40.0,
+     44.0/45.0, -56.0/15.0, 32.0/9.0,
+     19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0,
+     9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0, -5103.0/18656.0,
+     35.0/384.0, 0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0};
+  const CDATAFORMAT e[AUTOSTIFF_STAGES] = {71.0/57600.0, 0, -71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0, -1.0/40.0};
+
+  int i;
+  unsigned int s, j, idx;
+  unsigned int stride = props->statesize*PARALLEL_MODELS;
+  CDATAFORMAT *ks, *y;
+  CDATAFORMAT err, max_allowed_error, err_sum;
+  CDATAFORMAT dk, dy, dk_sum, dy_sum;
+  int ret = 0;
+
+  for(s=1; s<AUTOSTIFF_STAGES; s++){
+    idx = s*(s-1)/2;
+    // The final stage is evaluated at the solution itself
+    y = (s == AUTOSTIFF_STAGES-1) ? props->next_states : mem->temp;
+    for(i=props->statesize-1; i>=0; i--) {
+      y[STATE_IDX] = props->model_states[STATE_IDX];
+    }
+    for(j=0; j<s; j++){
+      ks = mem->k + j*stride;
+      for(i=props->statesize-1; i>=0; i--) {
+	y[STATE_IDX] += h*a[idx+j]*ks[STATE_IDX];
+      }
+    }
+    ret |= model_flows(props->time[modelid] + c[s]*h, y, mem->k + s*stride, props, 0, modelid);
+  }
+
+  // The last two stages are both evaluated at the end of the step, so the ratio of the
+  // differences of their flows and states approximates the dominant eigenvalue.
+  dk_sum = 0;
+  dy_sum = 0;
+  for(i=props->statesize-1; i>=0; i--) {
+    dk = mem->k[6*stride + STATE_IDX] - mem->k[5*stride + STATE_IDX];
+    dy = props->next_states[STATE_IDX] - mem->temp[STATE_IDX];
+    dk_sum += dk*dk;
+    dy_sum += dy*dy;
+  }
+  *hlambda = dy_sum > 0 ? h*sqrt(dk_sum/dy_sum) : 0;
+
+  err_sum = 0;
+  for(i=props->statesize-1; i>=0; i--) {
+    err = 0;
+    for(s=0; s<AUTOSTIFF_STAGES; s++){
+      err += e[s]*mem->k[s*stride + STATE_IDX];
+    }
+    err *= h;
+    max_allowed_error = props->reltol*MAX(fabs(props->next_states[STATE_IDX]),fabs(props->model_states[STATE_IDX]))+props->abstol;
+    err_sum += (err/max_allowed_error)*(err/max_allowed_error);
+  }
+  *norm = sqrt(err_sum/((CDATAFORMAT)props->statesize));
+
+  return ret;
+}
+
+// Records whether a step suggests switching methods.  An explicit step controlled near the
+// edge of its stability region alternates between either side of the bound, so evidence is
+// discarded only after several consecutive steps to the contrary.
+__DEVICE__
+void autostiff_evidence(autostiff_mem *mem, int suggests_switch, unsigned int modelid){
+  if (suggests_switch){
+    mem->switch_count[modelid]++;
+    mem->reset_count[modelid] = 0;
+  }
+  else if (++mem->reset_count[modelid] >= AUTOSTIFF_RESET_STEPS){
+    mem->switch_count[modelid] = 0;
+    mem->reset_count[modelid] = 0;
+  }
+}
+
+__DEVICE__
+int autostiff_eval(solver_props *props, unsigned int modelid){
+  autostiff_mem *mem = (autostiff_mem*)props->mem;
+  rosenbrock_tableau tab;
+  CDATAFORMAT norm, order;
+  CDATAFORMAT hlambda = 0;
+  CDATAFORMAT radius = 0;
+  unsigned int stiff = mem->stiff[modelid];
+  int appropriate_step = 0;
+  int ret;
+
+  if (stiff){
+    ret = model_flows(props->time[modelid], props->model_states, mem->work->f0, props, 1, modelid);
+    rosenbrock_tableau_init(ROSENBROCK_ROS3, &tab);
+    ret |= rosenbrock_jacobian(props, mem->work, modelid);
+    radius = rosenbrock_spectral_radius(props, mem->work, modelid);
+    order = tab.order;
+  }
+  else{
+    ret = model_flows(props->time[modelid], props->model_states, mem->k, props, 1, modelid);
+    order = 5;
+    // Estimate the first timestep ahead of the first step of the simulation, which is
+    // always explicit
+    if (0 == mem->prev_norm[modelid])
+      ret |= step_control_initial(props, order, mem->k, mem->temp, mem->k + props->statesize*PARALLEL_MODELS, &mem->cur_timestep[modelid], modelid);
+  }
+
+  while(!appropriate_step) {
+    if (stiff){
+      if (rosenbrock_attempt(props, mem->work, &tab, mem->cur_timestep[modelid], &norm, &appropriate_step, modelid))
+	return 1;
+    }
+    else{
+      ret |= autostiff_explicit_step(props, mem, mem->cur_timestep[modelid], &norm, &hlambda, modelid);
+      appropriate_step = step_control_accept(props, mem->cur_timestep[modelid], norm, modelid);
+    }
+
+    if (stiff){
+      // Count accepted steps which the explicit method could take stably
+      if (appropriate_step)
+	autostiff_evidence(mem, mem->cur_timestep[modelid]*radius < AUTOSTIFF_STABILITY_BOUND, modelid);
+    }
+    else{
+      // Count steps, including rejected ones, limited by stability rather than accuracy
+      if (hlambda > AUTOSTIFF_STABILITY_BOUND || appropriate_step)
+	autostiff_evidence(mem, hlambda > AUTOSTIFF_STABILITY_BOUND, modelid);
+    }
+
+    if (appropriate_step){
+      solver_step_time(props, mem->cur_timestep[modelid], modelid);
+    }
+
+    mem->cur_timestep[modelid] = step_control_adapt(props, mem->cur_timestep[modelid], norm, order, appropriate_step, mem->prev_norm, modelid);
+  }
+
+  if (mem->switch_count[modelid] >= AUTOSTIFF_SWITCH_STEPS){
+    mem->stiff[modelid] = !stiff;
+    mem->switch_count[modelid] = 0;
+    mem->reset_count[modelid] = 0;
+    // An explicit step is limited to the stability region; the implicit method keeps the
+    // step it was given and adapts from there.
+    if (stiff && radius > 0)
+      mem->cur_timestep[modelid] = MIN(mem->cur_timestep[modelid], AUTOSTIFF_STABILITY_BOUND/radius);
+  }
+
+  return ret;
+}
+
+__HOST__
+int autostiff_free(solver_props *props){
+#if defined TARGET_GPU
+  autostiff_mem tmem;
+  autostiff_mem *dmem = (autostiff_mem*)props->mem;
+
+  cutilSafeCall(cudaMemcpy(&tmem, dmem, sizeof(autostiff_mem), cudaMemcpyDeviceToHost));
+
+  cutilSafeCall(cudaFree(tmem.k));
+  cutilSafeCall(cudaFree(tmem.temp));
+  rosenbrock_work_free(tmem.work);
+  cutilSafeCall(cudaFree(tmem.cur_timestep));
+  cutilSafeCall(cudaFree(tmem.prev_norm));
+  cutilSafeCall(cudaFree(tmem.stiff));
+  cutilSafeCall(cudaFree(tmem.switch_count));
+  cutilSafeCall(cudaFree(tmem.reset_count));
+  cutilSafeCall(cudaFree(dmem));
+
+#else // Used for CPU and OPENMP targets
+
+  autostiff_mem *mem = (autostiff_mem*)props->mem;
+
+  free(mem->k);
+  free(mem->temp);
+  rosenbrock_work_free(mem->work);
+  free(mem->cur_timestep);
+  free(mem->prev_norm);
+  free(mem->stiff);
+  free(mem->switch_count);
+  free(mem->reset_count);
+  free(mem);
+#endif
+
+  return 0;
+}
@@ -9,6 +9,10 @@ typedef struct {
   CDATAFORMAT *temp;
   CDATAFORMAT *z_next_states;
   CDATAFORMAT *cur_timestep;
+  CDATAFORMAT *prev_norm; // Error norm of the previous accepted step, zero before the first
+#if NUM_EVENT_GUARDS > 0
+  solver_events *events;
+#endif
 } bogacki_shampine_mem;
 
 __HOST__
@@ -32,15 +36,21 @@ int bogacki_shampine_init(solver_props *props){
   cutilSafeCall(cudaMalloc((void**)&tmem.temp, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
   cutilSafeCall(cudaMalloc((void**)&tmem.z_next_states, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
   cutilSafeCall(cudaMalloc((void**)&tmem.cur_timestep, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.prev_norm, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
 
   // Create a local copy of the initial timestep and initialize
   temp_cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
   for(i=0; i<props->num_models; i++)
     temp_cur_timestep[i] = props->timestep;
 
+#if NUM_EVENT_GUARDS > 0
+  tmem.events = solver_events_init(props);
+#endif
+
   // Copy mem structure to GPU
   cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(bogacki_shampine_mem), cudaMemcpyHostToDevice));
   cutilSafeCall(cudaMemcpy(tmem.cur_timestep, temp_cur_timestep, props->num_models*sizeof(CDATAFORMAT), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemset(tmem.prev_norm, 0, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
 
   // Free temporary
   free(temp_cur_timestep);
@@ -61,6 +71,11 @@ int bogacki_shampine_init(solver_props *props){
   mem->cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
   for(i=0; i<props->num_models; i++)
     mem->cur_timestep[i] = props->timestep;
+  mem->prev_norm = (CDATAFORMAT*)calloc(PARALLEL_MODELS, sizeof(CDATAFORMAT));
+
+#if NUM_EVENT_GUARDS > 0
+  mem->events = solver_events_init(props);
+#endif
 #endif
 
   return 0;
@@ -68,14 +83,15 @@ int bogacki_shampine_init(solver_props *props){
 
 __DEVICE__
 int bogacki_shampine_eval(solver_props *props, unsigned int modelid){
-  CDATAFORMAT max_timestep = props->timestep*1024;
-  CDATAFORMAT min_timestep = props->timestep/1024;
-
   bogacki_shampine_mem *mem = (bogacki_shampine_mem*)props->mem;
 
   int i;
   int ret = model_flows(props->time[modelid], props->model_states, mem->k1, props, 1, modelid);
 
+  // Estimate the first timestep ahead of the first step of the simulation
+  if (0 == mem->prev_norm[modelid])
+    ret |= step_control_initial(props, 3, mem->k1, mem->temp, mem->k2, &mem->cur_timestep[modelid], modelid);
+
   int appropriate_step = 0;
 
   CDATAFORMAT max_error;
@@ -118,7 +134,6 @@ int bogacki_shampine_eval(solver_props *props, unsigned int modelid){
     max_error = -1e20;
     CDATAFORMAT max_allowed_error;
     CDATAFORMAT err_sum = 0;
-    CDATAFORMAT next_timestep;
 
     for(i=props->statesize-1; i>=0; i--) {
       err = fabs(props->next_states[STATE_IDX]-mem->z_next_states[STATE_IDX]);
@@ -133,27 +148,18 @@ int bogacki_shampine_eval(solver_props *props, unsigned int modelid){
     
     //CDATAFORMAT norm = max_error;
     CDATAFORMAT norm = sqrt(err_sum/props->statesize);
-    appropriate_step = norm <= 1;
-    if (mem->cur_timestep[modelid] == min_timestep) appropriate_step = 1;
+    appropriate_step = step_control_accept(props, mem->cur_timestep[modelid], norm, modelid);
 
     if (appropriate_step){
-      props->next_time[modelid] += mem->cur_timestep[modelid];
-    }
-
-    next_timestep = 0.90 * mem->cur_timestep[modelid]*pow(1.0/norm, 1.0/3.0);
-#if defined __DEVICE_EMULATION__
-    //fprintf(stderr,"model: %d ts: %g -> %g (norm=%g)\n", modelid, mem->cur_timestep[modelid], next_timestep, norm);
+#if NUM_EVENT_GUARDS > 0
+      // Truncate the step at the first event within it
+      solver_step_time(props, solver_locate_event(props, mem->events, mem->cur_timestep[modelid], mem->k1, mem->k4, modelid), modelid);
+#else
+      solver_step_time(props, mem->cur_timestep[modelid], modelid);
 #endif
+    }
 
-    // Try to hit the stoptime exactly
-    if (next_timestep > props->stoptime - props->next_time[modelid])
-      mem->cur_timestep[modelid] = props->stoptime - props->next_time[modelid];
-    else if ((isnan(next_timestep)) || (next_timestep < min_timestep))
-      mem->cur_timestep[modelid] = min_timestep;
-    else if (next_timestep > max_timestep )
-      mem->cur_timestep[modelid] = max_timestep;
-    else
-      mem->cur_timestep[modelid] = next_timestep;
+    mem->cur_timestep[modelid] = step_control_adapt(props, mem->cur_timestep[modelid], norm, 3, appropriate_step, mem->prev_norm, modelid);
 
   }
 
@@ -181,6 +187,10 @@ int bogacki_shampine_free(solver_props *props){
   cutilSafeCall(cudaFree(tmem.temp));
   cutilSafeCall(cudaFree(tmem.z_next_states));
   cutilSafeCall(cudaFree(tmem.cur_timestep));
+  cutilSafeCall(cudaFree(tmem.prev_norm));
+#if NUM_EVENT_GUARDS > 0
+  solver_events_free(tmem.events);
+#endif
   cutilSafeCall(cudaFree(dmem));
 
 #else // Used for CPU and OPENMP targets
@@ -194,6 +204,10 @@ int bogacki_shampine_free(solver_props *props){
   free(mem->temp);
   free(mem->z_next_states);
   free(mem->cur_timestep);
+  free(mem->prev_norm);
+#if NUM_EVENT_GUARDS > 0
+  solver_events_free(mem->events);
+#endif
   free(mem);
 
 #endif
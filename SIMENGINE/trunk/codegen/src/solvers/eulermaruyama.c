@@ -0,0 +1,89 @@
+// Euler-Maruyama Integration Method
+// Strong order 1/2, weak order 1 explicit method for stochastic differential equations
+//   dy = f(t,y) dt + g(t,y) dW
+// with diagonal noise, where g is the coefficient of wiener() in each differential equation.
+// Copyright 2009, 2010 Simatra Modeling Technologies, L.L.C.
+
+typedef struct {
+  CDATAFORMAT *f; // Drift
+  CDATAFORMAT *g; // Diffusion
+  CDATAFORMAT *dW; // Wiener increments
+} eulermaruyama_mem;
+
+__HOST__
+int eulermaruyama_init(solver_props *props){
+#if defined TARGET_GPU
+  // Temporary CPU copies of GPU datastructures
+  eulermaruyama_mem tmem;
+  // GPU datastructures
+  eulermaruyama_mem *dmem;
+  
+  // Allocate GPU space for mem and pointer fields of mem (other than props)
+  cutilSafeCall(cudaMalloc((void**)&dmem, sizeof(eulermaruyama_mem)));
+  props->mem = dmem;
+  cutilSafeCall(cudaMalloc((void**)&tmem.f, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.g, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.dW, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+
+  // Copy mem structure to GPU
+  cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(eulermaruyama_mem), cudaMemcpyHostToDevice));
+
+#else // Used for CPU and OPENMP targets
+
+  eulermaruyama_mem *mem = (eulermaruyama_mem*)malloc(sizeof(eulermaruyama_mem));
+
+  props->mem = mem;
+  mem->f = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->g = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->dW = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+#endif
+
+  return 0;
+}
+
+__DEVICE__
+int eulermaruyama_eval(solver_props *props, unsigned int modelid){
+  int i;
+  int ret;
+
+  eulermaruyama_mem *mem = (eulermaruyama_mem*)props->mem;
+
+  ret = solver_drift_diffusion(props, props->time[modelid], props->model_states, mem->f, mem->g, 1, modelid);
+  solver_wiener_increments(props, props->timestep, mem->dW, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] +
+      props->timestep * mem->f[STATE_IDX] +
+      mem->g[STATE_IDX] * mem->dW[STATE_IDX];
+  }
+
+  solver_step_time(props, props->timestep, modelid);
+
+  return ret;
+}
+
+__HOST__
+int eulermaruyama_free(solver_props *props){
+#if defined TARGET_GPU
+  eulermaruyama_mem *dmem = (eulermaruyama_mem*)props->mem;
+  eulermaruyama_mem tmem;
+
+  cutilSafeCall(cudaMemcpy(&tmem, dmem, sizeof(eulermaruyama_mem), cudaMemcpyDeviceToHost));
+
+  cutilSafeCall(cudaFree(tmem.f));
+  cutilSafeCall(cudaFree(tmem.g));
+  cutilSafeCall(cudaFree(tmem.dW));
+  cutilSafeCall(cudaFree(dmem));
+
+#else // Used for CPU and OPENMP targets
+
+  eulermaruyama_mem *mem =(eulermaruyama_mem*)props->mem;
+
+  free(mem->f);
+  free(mem->g);
+  free(mem->dW);
+  free(mem);
+#endif // defined TARGET_GPU
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+// Storage of the event guards written by the update flows, see solvers.h for their definitions.
+#if NUM_EVENT_GUARDS > 0
+
+#ifndef TARGET_GPU
+// Defined in solvers.h, declared here for the flows of the CPU targets
+extern CDATAFORMAT event_guards[NUM_EVENT_GUARDS*PARALLEL_MODELS];
+extern unsigned int event_guard_count[PARALLEL_MODELS];
+#endif
+
+#define EVENT_GUARD(g) do {						\
+    if (event_guard_count[modelid] < NUM_EVENT_GUARDS)			\
+      event_guards[TARGET_IDX(NUM_EVENT_GUARDS, PARALLEL_MODELS, event_guard_count[modelid]++, modelid)] = (g); \
+  } while (0)
+
+#endif
@@ -15,10 +15,10 @@ int forwardeuler_eval(solver_props *props, unsigned int modelid){
   for(i=props->statesize-1; i>=0; i--) {
     // Store the next state internally until updated before next iteration
     props->next_states[STATE_IDX] = props->model_states[STATE_IDX] +
-      props->timestep * props->next_states[STATE_IDX];
+      (CDATAACCUM)props->timestep * props->next_states[STATE_IDX];
   }
 
-  props->next_time[modelid] += props->timestep;
+  solver_step_time(props, props->timestep, modelid);
 
   return ret;
 }
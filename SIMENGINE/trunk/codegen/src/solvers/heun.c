@@ -81,10 +81,10 @@ int heun_eval(solver_props *props, unsigned int modelid){
   ret |= model_flows(props->time[modelid]+(props->timestep/2), mem->temp, mem->predictor, props, 0, modelid);
 
   for(i=props->statesize-1; i>=0; i--) {
-    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] + (props->timestep/2) * (mem->base[STATE_IDX]+mem->predictor[STATE_IDX]);
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] + ((CDATAACCUM)props->timestep/2) * ((CDATAACCUM)mem->base[STATE_IDX]+mem->predictor[STATE_IDX]);
   }
 
-  props->next_time[modelid] += props->timestep;
+  solver_step_time(props, props->timestep, modelid);
 
   return ret;
 }
@@ -71,7 +71,7 @@ int linearbackwardeuler_eval(solver_props *props, unsigned int modelid){
     return 1;
   }
 
-  props->next_time[modelid] += props->timestep;
+  solver_step_time(props, props->timestep, modelid);
 
   return ret;
 }
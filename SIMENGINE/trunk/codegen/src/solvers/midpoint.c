@@ -49,10 +49,10 @@ int midpoint_eval(solver_props *props, unsigned int modelid){
   ret |= model_flows(props->time[modelid]+(props->timestep/2), mem->temp, props->next_states, props, 0, modelid);
 
   for(i=props->statesize-1; i>=0; i--) {
-    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] + (props->timestep/2) * props->next_states[STATE_IDX];
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] + ((CDATAACCUM)props->timestep/2) * props->next_states[STATE_IDX];
   }  
 
-  props->next_time[modelid] += props->timestep;
+  solver_step_time(props, props->timestep, modelid);
 
   return ret;
 }
@@ -0,0 +1,114 @@
+// Milstein Integration Method
+// Strong order 1 explicit method for stochastic differential equations with diagonal noise.
+// The derivative of the diffusion is replaced by a finite difference along a supporting
+// value, following the derivative-free scheme of Kloeden and Platen (11.1.5).
+// Copyright 2009, 2010 Simatra Modeling Technologies, L.L.C.
+
+typedef struct {
+  CDATAFORMAT *f; // Drift
+  CDATAFORMAT *g; // Diffusion
+  CDATAFORMAT *dW; // Wiener increments
+  CDATAFORMAT *temp; // Supporting value
+  CDATAFORMAT *fs; // Drift at the supporting value
+  CDATAFORMAT *gs; // Diffusion at the supporting value
+} milstein_mem;
+
+__HOST__
+int milstein_init(solver_props *props){
+#if defined TARGET_GPU
+  // Temporary CPU copies of GPU datastructures
+  milstein_mem tmem;
+  // GPU datastructures
+  milstein_mem *dmem;
+  
+  // Allocate GPU space for mem and pointer fields of mem (other than props)
+  cutilSafeCall(cudaMalloc((void**)&dmem, sizeof(milstein_mem)));
+  props->mem = dmem;
+  cutilSafeCall(cudaMalloc((void**)&tmem.f, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.g, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.dW, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.temp, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.fs, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.gs, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+
+  // Copy mem structure to GPU
+  cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(milstein_mem), cudaMemcpyHostToDevice));
+
+#else // Used for CPU and OPENMP targets
+
+  milstein_mem *mem = (milstein_mem*)malloc(sizeof(milstein_mem));
+
+  props->mem = mem;
+  mem->f = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->g = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->dW = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->temp = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->fs = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->gs = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+#endif
+
+  return 0;
+}
+
+__DEVICE__
+int milstein_eval(solver_props *props, unsigned int modelid){
+  int i;
+  int ret;
+  CDATAFORMAT h = props->timestep;
+  CDATAFORMAT sqrt_h = sqrt(h);
+
+  milstein_mem *mem = (milstein_mem*)props->mem;
+
+  ret = solver_drift_diffusion(props, props->time[modelid], props->model_states, mem->f, mem->g, 1, modelid);
+  solver_wiener_increments(props, h, mem->dW, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    mem->temp[STATE_IDX] = props->model_states[STATE_IDX] +
+      h * mem->f[STATE_IDX] + sqrt_h * mem->g[STATE_IDX];
+  }
+  ret |= solver_drift_diffusion(props, props->time[modelid], mem->temp, mem->fs, mem->gs, 0, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    CDATAFORMAT dW = mem->dW[STATE_IDX];
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] +
+      h * mem->f[STATE_IDX] +
+      mem->g[STATE_IDX] * dW +
+      (mem->gs[STATE_IDX] - mem->g[STATE_IDX]) * (dW*dW - h) / (2*sqrt_h);
+  }
+
+  solver_step_time(props, h, modelid);
+
+  return ret;
+}
+
+__HOST__
+int milstein_free(solver_props *props){
+#if defined TARGET_GPU
+  milstein_mem *dmem = (milstein_mem*)props->mem;
+  milstein_mem tmem;
+
+  cutilSafeCall(cudaMemcpy(&tmem, dmem, sizeof(milstein_mem), cudaMemcpyDeviceToHost));
+
+  cutilSafeCall(cudaFree(tmem.f));
+  cutilSafeCall(cudaFree(tmem.g));
+  cutilSafeCall(cudaFree(tmem.dW));
+  cutilSafeCall(cudaFree(tmem.temp));
+  cutilSafeCall(cudaFree(tmem.fs));
+  cutilSafeCall(cudaFree(tmem.gs));
+  cutilSafeCall(cudaFree(dmem));
+
+#else // Used for CPU and OPENMP targets
+
+  milstein_mem *mem =(milstein_mem*)props->mem;
+
+  free(mem->f);
+  free(mem->g);
+  free(mem->dW);
+  free(mem->temp);
+  free(mem->fs);
+  free(mem->gs);
+  free(mem);
+#endif // defined TARGET_GPU
+
+  return 0;
+}
@@ -72,13 +72,13 @@ int rk4_eval(solver_props *props, unsigned int modelid){
 
   for(i=props->statesize-1; i>=0; i--) {
     props->next_states[STATE_IDX] = props->model_states[STATE_IDX] +
-      (props->timestep/6.0) * (mem->k1[STATE_IDX] +
+      (props->timestep/6.0) * ((CDATAACCUM)mem->k1[STATE_IDX] +
 				    2*mem->k2[STATE_IDX] +
 				    2*mem->k3[STATE_IDX] +
 				    mem->k4[STATE_IDX]);
   }
 
-  props->next_time[modelid] += props->timestep;
+  solver_step_time(props, props->timestep, modelid);
 
   return ret;
 }
@@ -0,0 +1,130 @@
+// Rosenbrock (linearly implicit) Integration Methods
+// Variable timestep solvers for stiff systems.  Each step solves a fixed number of linear
+// systems with the matrix I/(h*gamma) - J, where J is the Jacobian of the flows, in place of
+// the Newton iterations of a fully implicit method.  An embedded lower order solution
+// provides the error estimate used to adapt the timestep.
+//
+// The Jacobian is formed per instance by forward differences of the flows, one column per
+// state, and factored once per step attempt.  All working storage uses the same per-instance
+// layout as the model states so that instances are batched as in the explicit solvers.
+//
+// Coefficients are those of Sandu et al., "Benchmarking stiff ODE solvers for atmospheric
+// chemistry problems II: Rosenbrock solvers", Atmos. Env. 31 (1997).
+// Copyright 2009, 2010 Simatra Modeling Technologies, L.L.C.
+
+typedef struct {
+  unsigned int method;
+} rosenbrock_opts;
+
+typedef struct {
+  rosenbrock_work *work;
+  CDATAFORMAT *cur_timestep;
+  CDATAFORMAT *prev_norm; // Error norm of the previous accepted step, zero before the first
+} rosenbrock_mem;
+
+__HOST__
+int rosenbrock_init(solver_props *props){
+  unsigned int i;
+#if defined TARGET_GPU
+  // Temporary CPU copies of GPU datastructures
+  rosenbrock_mem tmem;
+  // GPU datastructures
+  rosenbrock_mem *dmem;
+
+  CDATAFORMAT *temp_cur_timestep;
+
+  // Allocate GPU space for mem and pointer fields of mem (other than props)
+  cutilSafeCall(cudaMalloc((void**)&dmem, sizeof(rosenbrock_mem)));
+  props->mem = dmem;
+  tmem.work = rosenbrock_work_init(props);
+  cutilSafeCall(cudaMalloc((void**)&tmem.cur_timestep, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.prev_norm, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+
+  // Create a local copy of the initial timestep and initialize
+  temp_cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  for(i=0; i<props->num_models; i++)
+    temp_cur_timestep[i] = props->timestep;
+
+  // Copy mem structure to GPU
+  cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(rosenbrock_mem), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemcpy(tmem.cur_timestep, temp_cur_timestep, props->num_models*sizeof(CDATAFORMAT), cudaMemcpyHostToDevice));
+  cutilSafeCall(cudaMemset(tmem.prev_norm, 0, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+
+  // Free temporary
+  free(temp_cur_timestep);
+
+#else // Used for CPU and OPENMP targets
+
+  rosenbrock_mem *mem = (rosenbrock_mem*)malloc(sizeof(rosenbrock_mem));
+
+  props->mem = mem;
+  mem->work = rosenbrock_work_init(props);
+
+  // Allocate and initialize timesteps
+  mem->cur_timestep = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  for(i=0; i<props->num_models; i++)
+    mem->cur_timestep[i] = props->timestep;
+  mem->prev_norm = (CDATAFORMAT*)calloc(PARALLEL_MODELS, sizeof(CDATAFORMAT));
+#endif
+
+  return 0;
+}
+
+__DEVICE__
+int rosenbrock_eval(solver_props *props, unsigned int modelid){
+  rosenbrock_mem *mem = (rosenbrock_mem*)props->mem;
+  rosenbrock_opts *opts = (rosenbrock_opts*)&props->opts;
+  rosenbrock_tableau tab;
+  CDATAFORMAT norm;
+  int appropriate_step = 0;
+
+  int ret = model_flows(props->time[modelid], props->model_states, mem->work->f0, props, 1, modelid);
+
+  rosenbrock_tableau_init(opts->method, &tab);
+
+  // Estimate the first timestep ahead of the first step of the simulation
+  if (0 == mem->prev_norm[modelid])
+    ret |= step_control_initial(props, tab.order, mem->work->f0, mem->work->temp, mem->work->fstage, &mem->cur_timestep[modelid], modelid);
+
+  // The Jacobian is held fixed over rejected attempts of the same step
+  ret |= rosenbrock_jacobian(props, mem->work, modelid);
+
+  while(!appropriate_step) {
+    if (rosenbrock_attempt(props, mem->work, &tab, mem->cur_timestep[modelid], &norm, &appropriate_step, modelid))
+      return 1;
+
+    if (appropriate_step){
+      solver_step_time(props, mem->cur_timestep[modelid], modelid);
+    }
+
+    mem->cur_timestep[modelid] = step_control_adapt(props, mem->cur_timestep[modelid], norm, tab.order, appropriate_step, mem->prev_norm, modelid);
+  }
+
+  return ret;
+}
+
+__HOST__
+int rosenbrock_free(solver_props *props){
+#if defined TARGET_GPU
+  rosenbrock_mem tmem;
+  rosenbrock_mem *dmem = (rosenbrock_mem*)props->mem;
+
+  cutilSafeCall(cudaMemcpy(&tmem, dmem, sizeof(rosenbrock_mem), cudaMemcpyDeviceToHost));
+
+  rosenbrock_work_free(tmem.work);
+  cutilSafeCall(cudaFree(tmem.cur_timestep));
+  cutilSafeCall(cudaFree(tmem.prev_norm));
+  cutilSafeCall(cudaFree(dmem));
+
+#else // Used for CPU and OPENMP targets
+
+  rosenbrock_mem *mem = (rosenbrock_mem*)props->mem;
+
+  rosenbrock_work_free(mem->work);
+  free(mem->cur_timestep);
+  free(mem->prev_norm);
+  free(mem);
+#endif
+
+  return 0;
+}
@@ -13,6 +13,9 @@ __DEVICE__ CDATAFORMAT gpu_next_time[PARALLEL_MODELS * NUM_ITERATORS];
 
 __DEVICE__ unsigned int gpu_count[PARALLEL_MODELS * NUM_ITERATORS];
 
+// Needs to be copied device-to-host.
+__DEVICE__ solver_stats gpu_stats[PARALLEL_MODELS * NUM_ITERATORS];
+
 // Needs to be coped device-to-host.
 __DEVICE__ top_systemstatedata gpu_system[1];
 
@@ -82,6 +85,7 @@ solver_props *gpu_init_props(solver_props *props){
   top_systemstatedata *g_system;
   CDATAFORMAT *g_time, *g_next_time;
   unsigned int *g_count;
+  solver_stats *g_stats;
   int *g_running, *g_last_iteration;
   output_buffer *g_ob;
 
@@ -90,6 +94,7 @@ solver_props *gpu_init_props(solver_props *props){
   cutilSafeCall(cudaGetSymbolAddress((void **)&g_time, gpu_time));
   cutilSafeCall(cudaGetSymbolAddress((void **)&g_next_time, gpu_next_time));
   cutilSafeCall(cudaGetSymbolAddress((void **)&g_count, gpu_count));
+  cutilSafeCall(cudaGetSymbolAddress((void **)&g_stats, gpu_stats));
 
   if (NUM_STATES > 0 || NUM_ITERATORS > 1) {
     cutilSafeCall(cudaGetSymbolAddress((void **)&g_system, gpu_system));
@@ -141,6 +146,7 @@ solver_props *gpu_init_props(solver_props *props){
     tmp_props[i].time = g_time + (i * PARALLEL_MODELS);
     tmp_props[i].next_time = g_next_time + (i * PARALLEL_MODELS);
     tmp_props[i].count = g_count + (i * PARALLEL_MODELS);
+    tmp_props[i].stats = g_stats + (i * PARALLEL_MODELS);
     tmp_props[i].running = g_running + (i * PARALLEL_MODELS);
     tmp_props[i].last_iteration = g_last_iteration + (i * PARALLEL_MODELS);
 
@@ -164,6 +170,7 @@ solver_props *gpu_init_props(solver_props *props){
     // Pointers to device global memory that the host needs
     props[i].gpu.time = tmp_props[i].time;
     props[i].gpu.model_states = tmp_props[i].model_states;
+    props[i].gpu.stats = tmp_props[i].stats;
   }
 
   // A temporary host duplicate of the system states pointers structure.
@@ -201,6 +208,7 @@ solver_props *gpu_init_props(solver_props *props){
 
   cutilSafeCall(cudaMemset(g_last_iteration, 0, PARALLEL_MODELS * NUM_ITERATORS * sizeof(int)));
   cutilSafeCall(cudaMemset(g_count, 0, PARALLEL_MODELS * NUM_ITERATORS * sizeof(int)));
+  cutilSafeCall(cudaMemset(g_stats, 0, PARALLEL_MODELS * NUM_ITERATORS * sizeof(solver_stats)));
 
   // Zeroes the initial output buffer to ensure the finished flags start at 0
   cutilSafeCall(cudaMemset(g_ob, 0, sizeof(output_buffer)));
@@ -208,7 +216,7 @@ solver_props *gpu_init_props(solver_props *props){
   return g_props;
 }
 
-// Copies final times and states back to host main memory.
+// Copies final times, solver statistics and states back to host main memory.
 void gpu_finalize_props (solver_props *props) {
   unsigned int i;
   // A temporary host duplicate of the time vectors.
@@ -219,6 +227,7 @@ void gpu_finalize_props (solver_props *props) {
   for (i = 0; i < NUM_ITERATORS; i++) {
     // Each iterator has its own area of memory
     memcpy(props[i].time, tmp_time + (i * PARALLEL_MODELS), PARALLEL_MODELS * sizeof(CDATAFORMAT));
+    cutilSafeCall(cudaMemcpy(props[i].stats, props[i].gpu.stats, PARALLEL_MODELS * sizeof(solver_stats), cudaMemcpyDeviceToHost));
   }
 
   // Copies final states from the device
@@ -18,10 +18,18 @@
 // Properties data structure
 // ============================================================================================================
 
+// Counts of the work done by an iterator for a single model instance
+typedef struct {
+  unsigned int accepted; // Steps taken
+  unsigned int rejected; // Steps attempted and rejected by a variable timestep solver
+  unsigned int flows; // Evaluations of the flows
+} solver_stats;
+
 // Pointers to GPU device memory, used only on the Host for transfers
 typedef struct {
   CDATAFORMAT *time;
   CDATAFORMAT *model_states;
+  solver_stats *stats;
   void *mem;
 } gpu_data;
 
@@ -41,13 +49,17 @@ typedef struct {
                         // sample period for discrete
   CDATAFORMAT abstol;
   CDATAFORMAT reltol;
+  CDATAFORMAT min_factor; // Bounds on the change of a variable timestep within a single adjustment
+  CDATAFORMAT max_factor;
   CDATAFORMAT starttime;
   CDATAFORMAT stoptime;
   // A pointer to a systemstatedata_ptr structure
   top_systemstatedata *system_states;
   CDATAFORMAT *time; // Continuous iterators (discrete mapped to continuous)
   CDATAFORMAT *next_time;
+  CDATAFORMAT *time_error; // Rounding error carried between steps of next_time (mixed precision)
   unsigned int *count; // Discrete iterators
+  solver_stats *stats;
   // A pointer into system_states to the states for this iterator
   CDATAFORMAT *model_states;
   CDATAFORMAT *next_states;
@@ -73,6 +85,7 @@ typedef struct {
 // Pre-declaration of model_flows, the interface between the solver and the model
 __DEVICE__ int model_flows(CDATAFORMAT iterval, CDATAFORMAT *y, CDATAFORMAT *dydt, solver_props *props, unsigned int first_iteration, unsigned int modelid);
 __DEVICE__ int model_running(solver_props *props, unsigned int modelid);
+__HOST__ __DEVICE__ int update(solver_props *props, unsigned int modelid);
 int init_states(solver_props *props, const unsigned int modelid);
 
 
@@ -91,10 +104,26 @@ __DEVICE__ int solver_advance(solver_props *props, const unsigned int modelid){
 
   // Now all solvers have a count field to keep track of the number of steps
   props->count[modelid]++;
+  props->stats[modelid].accepted++;
 
   return props->last_iteration[modelid];
 }
 
+// Advances the next iterator value of a solver by a step h for a given model id.
+// With mixed precision, the rounding error of each addition is carried into the
+// next (Kahan summation) so that single precision time does not drift over many
+// small steps.
+__DEVICE__ void solver_step_time(solver_props *props, CDATAFORMAT h, const unsigned int modelid){
+#if defined SIMENGINE_MIXED_PRECISION
+  CDATAFORMAT y = h - props->time_error[modelid];
+  CDATAFORMAT t = props->next_time[modelid] + y;
+  props->time_error[modelid] = (t - props->next_time[modelid]) - y;
+  props->next_time[modelid] = t;
+#else
+  props->next_time[modelid] += h;
+#endif
+}
+
 __HOST__ __DEVICE__ void solver_writeback(solver_props *props, const unsigned int modelid){
   unsigned int i, index;
   CDATAFORMAT *algebraic_states, *algebraic_next_states;
@@ -149,4 +178,736 @@ __DEVICE__ int model_running(solver_props *props, unsigned int modelid){
   return 0;
 }
 
+// Adaptive step control
+// ============================================================================================================
+
+// Variable timestep solvers adapt their steps with a proportional-integral controller on the
+// weighted RMS norm of the embedded error estimate, which damps the oscillation of the step
+// about the stability limit of an explicit method (Gustafsson, "Control theoretic techniques
+// for stepsize selection in explicit Runge-Kutta methods", ACM TOMS 17 (1991)).  A step is
+// accepted when the norm is at most one.
+#define STEP_SAFETY 0.9
+// Exponents of the current and previous error norms, each divided by the order of the estimate
+#define STEP_ALPHA 0.85
+#define STEP_BETA 0.2
+// Floor of the previous error norm, so that an exact step does not stall the controller
+#define STEP_MIN_NORM 1e-4
+// Bound on the ratio between the timestep and the first timestep given to the solver
+#define STEP_RANGE 1024
+
+// Estimates the first timestep for the states and flows f0 at the start of the simulation
+// (Hairer, Norsett and Wanner, "Solving Ordinary Differential Equations I", II.4).  The flows
+// at an Euler step of a trial size, evaluated into y1 and f1, measure the second derivative.
+// The estimate never exceeds the first timestep given to the solver.
+__DEVICE__ int step_control_initial(solver_props *props, CDATAFORMAT order, CDATAFORMAT *f0, CDATAFORMAT *y1, CDATAFORMAT *f1, CDATAFORMAT *h, unsigned int modelid){
+  int i;
+  CDATAFORMAT scale, d0 = 0, d1 = 0, d2 = 0, h0, h1;
+  int ret;
+
+  if (0 == props->statesize){
+    *h = props->timestep;
+    return 0;
+  }
+
+  for(i=props->statesize-1; i>=0; i--) {
+    scale = props->reltol*fabs(props->model_states[STATE_IDX])+props->abstol;
+    d0 += (props->model_states[STATE_IDX]/scale)*(props->model_states[STATE_IDX]/scale);
+    d1 += (f0[STATE_IDX]/scale)*(f0[STATE_IDX]/scale);
+  }
+  d0 = sqrt(d0/props->statesize);
+  d1 = sqrt(d1/props->statesize);
+
+  h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01*d0/d1;
+  h0 = MIN(h0, props->timestep);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    y1[STATE_IDX] = props->model_states[STATE_IDX] + h0*f0[STATE_IDX];
+  }
+  ret = model_flows(props->time[modelid]+h0, y1, f1, props, 0, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    scale = props->reltol*fabs(props->model_states[STATE_IDX])+props->abstol;
+    d2 += ((f1[STATE_IDX]-f0[STATE_IDX])/scale)*((f1[STATE_IDX]-f0[STATE_IDX])/scale);
+  }
+  d2 = sqrt(d2/props->statesize)/h0;
+
+  if (MAX(d1, d2) <= 1e-15)
+    h1 = MAX(1e-6, h0*1e-3);
+  else
+    h1 = pow(0.01/MAX(d1, d2), 1.0/order);
+
+  *h = MIN(MIN(100*h0, h1), props->timestep);
+  if (isnan(*h) || *h < props->timestep/STEP_RANGE)
+    *h = props->timestep/STEP_RANGE;
+
+  return ret;
+}
+
+// Decides whether an attempted step of size h is accepted given the norm of its error estimate
+// and counts rejected attempts.  A step at the minimum timestep is always accepted.
+__DEVICE__ int step_control_accept(solver_props *props, CDATAFORMAT h, CDATAFORMAT norm, unsigned int modelid){
+  int accepted = norm <= 1 || h == props->timestep/STEP_RANGE;
+
+  if (!accepted)
+    props->stats[modelid].rejected++;
+
+  return accepted;
+}
+
+// Returns the timestep to attempt after an attempt of size h.  Accepted steps are controlled
+// by the current and previous error norms; the previous norm, initially zero, is updated in
+// place.  Following a rejection the step is reduced by the current norm alone and never grows.
+// The change is limited to the min_factor and max_factor of the solver, and the result to the
+// range of timesteps and the stop time.
+__DEVICE__ CDATAFORMAT step_control_adapt(solver_props *props, CDATAFORMAT h, CDATAFORMAT norm, CDATAFORMAT order, int accepted, CDATAFORMAT *prev_norm, unsigned int modelid){
+  CDATAFORMAT max_timestep = props->timestep*STEP_RANGE;
+  CDATAFORMAT min_timestep = props->timestep/STEP_RANGE;
+  CDATAFORMAT factor, next_timestep;
+
+  if (norm <= 0)
+    factor = props->max_factor;
+  else if (accepted && prev_norm[modelid] > 0)
+    factor = STEP_SAFETY * pow(norm, -STEP_ALPHA/order) * pow(prev_norm[modelid], STEP_BETA/order);
+  else
+    factor = STEP_SAFETY * pow(norm, -1.0/order);
+
+  // Comparisons leave an undefined factor in place to be caught below
+  if (factor > props->max_factor)
+    factor = props->max_factor;
+  else if (factor < props->min_factor)
+    factor = props->min_factor;
+  if (accepted)
+    prev_norm[modelid] = MAX(norm, STEP_MIN_NORM);
+  else if (factor > 1)
+    factor = 1;
+
+  next_timestep = h*factor;
+
+  // Try to hit the stoptime exactly
+  if (next_timestep > props->stoptime - props->next_time[modelid])
+    return props->stoptime - props->next_time[modelid];
+  else if ((isnan(next_timestep)) || (next_timestep < min_timestep))
+    return min_timestep;
+  else if (next_timestep > max_timestep )
+    return max_timestep;
+  else
+    return next_timestep;
+}
+
+// Stochastic integration
+// ============================================================================================================
+
+// Scale of the wiener() white noise terms in the flows.  It is zero except while a stochastic
+// solver evaluates the flows to separate the diffusion of each state from its drift, so the
+// flows of any other solver, and any outputs, see the drift alone.
+__DEVICE__ CDATAFORMAT wiener_scale[PARALLEL_MODELS];
+
+// Evaluates the drift f and the diagonal diffusion g of the flows at states y and time t.
+// The flows are linear in the noise, so g is the difference between evaluations with the
+// noise scaled by one and by zero.
+__DEVICE__ int solver_drift_diffusion(solver_props *props, CDATAFORMAT t, CDATAFORMAT *y, CDATAFORMAT *f, CDATAFORMAT *g, unsigned int first_iteration, unsigned int modelid){
+  int i;
+  int ret;
+
+  wiener_scale[modelid] = 0;
+  ret = model_flows(t, y, f, props, first_iteration, modelid);
+  wiener_scale[modelid] = 1;
+  ret |= model_flows(t, y, g, props, 0, modelid);
+  wiener_scale[modelid] = 0;
+
+  for(i=props->statesize-1; i>=0; i--) {
+    g[STATE_IDX] -= f[STATE_IDX];
+  }
+
+  return ret;
+}
+
+// Draws independent Wiener increments over a step of size h for every state in a single
+// pass, two deviates per block of random bits.
+__DEVICE__ void solver_wiener_increments(solver_props *props, CDATAFORMAT h, CDATAFORMAT *dW, unsigned int modelid){
+  unsigned int i;
+  CDATAFORMAT z[2];
+  CDATAFORMAT sqrt_h = sqrt(h);
+
+  for(i=0; i<props->statesize; i+=2) {
+    DEVICE_NORMAL_RANDOM_PAIR(PARALLEL_MODELS, modelid, z);
+    dW[STATE_IDX] = sqrt_h*z[0];
+    if (i+1 < props->statesize) {
+      dW[TARGET_IDX(props->statesize, PARALLEL_MODELS, i+1, modelid)] = sqrt_h*z[1];
+    }
+  }
+}
+
+// Linearly implicit integration
+// ============================================================================================================
+
+// Rosenbrock methods
+#define ROSENBROCK_ROS3 0   // 3 stages, order 3(2), L-stable
+#define ROSENBROCK_RODAS3 1 // 4 stages, order 3(2), stiffly accurate
+
+#define ROSENBROCK_MAX_STAGES 4
+
+// Relative perturbation of the states when differencing the flows
+#if defined SIMENGINE_STORAGE_float
+#define ROSENBROCK_JACOBIAN_DELTA 3.4e-4f
+#else
+#define ROSENBROCK_JACOBIAN_DELTA 1.5e-8
+#endif
+
+typedef struct {
+  unsigned int stages;
+  CDATAFORMAT order; // Order of the error estimate
+  int new_f[ROSENBROCK_MAX_STAGES]; // Whether a stage evaluates the flows
+  CDATAFORMAT alpha[ROSENBROCK_MAX_STAGES]; // Time offset of each stage
+  CDATAFORMAT gamma[ROSENBROCK_MAX_STAGES]; // Coefficient of the time derivative
+  CDATAFORMAT a[ROSENBROCK_MAX_STAGES*(ROSENBROCK_MAX_STAGES-1)/2]; // Stage states, packed lower triangle
+  CDATAFORMAT c[ROSENBROCK_MAX_STAGES*(ROSENBROCK_MAX_STAGES-1)/2]; // Stage couplings, packed lower triangle
+  CDATAFORMAT m[ROSENBROCK_MAX_STAGES]; // Weights of the solution
+  CDATAFORMAT e[ROSENBROCK_MAX_STAGES]; // Weights of the error estimate
+} rosenbrock_tableau;
+
+// Working space of a Rosenbrock step
+typedef struct {
+  CDATAFORMAT *k; // Stage vectors, ROSENBROCK_MAX_STAGES consecutive state arrays
+  CDATAFORMAT *f0; // Flows at the beginning of the step
+  CDATAFORMAT *fstage; // Flows at the most recent stage state
+  CDATAFORMAT *dfdt; // Time derivative of the flows
+  CDATAFORMAT *temp;
+  CDATAFORMAT *jacobian; // Dense statesize*statesize matrix per instance
+  CDATAFORMAT *lu; // Factored iteration matrix
+  unsigned int *pivots;
+} rosenbrock_work;
+
+__HOST__ rosenbrock_work *rosenbrock_work_init(solver_props *props){
+  unsigned int n = props->statesize;
+#if defined TARGET_GPU
+  rosenbrock_work twork;
+  rosenbrock_work *dwork;
+
+  cutilSafeCall(cudaMalloc((void**)&dwork, sizeof(rosenbrock_work)));
+  cutilSafeCall(cudaMalloc((void**)&twork.k, ROSENBROCK_MAX_STAGES*n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.f0, n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.fstage, n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.dfdt, n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.temp, n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.jacobian, n*n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.lu, n*n*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&twork.pivots, n*PARALLEL_MODELS*sizeof(unsigned int)));
+  cutilSafeCall(cudaMemcpy(dwork, &twork, sizeof(rosenbrock_work), cudaMemcpyHostToDevice));
+
+  return dwork;
+#else
+  rosenbrock_work *work = (rosenbrock_work*)malloc(sizeof(rosenbrock_work));
+
+  work->k = (CDATAFORMAT*)malloc(ROSENBROCK_MAX_STAGES*n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->f0 = (CDATAFORMAT*)malloc(n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->fstage = (CDATAFORMAT*)malloc(n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->dfdt = (CDATAFORMAT*)malloc(n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->temp = (CDATAFORMAT*)malloc(n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->jacobian = (CDATAFORMAT*)malloc(n*n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->lu = (CDATAFORMAT*)malloc(n*n*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  work->pivots = (unsigned int*)malloc(n*PARALLEL_MODELS*sizeof(unsigned int));
+
+  return work;
+#endif
+}
+
+__HOST__ void rosenbrock_work_free(rosenbrock_work *work){
+#if defined TARGET_GPU
+  rosenbrock_work twork;
+
+  cutilSafeCall(cudaMemcpy(&twork, work, sizeof(rosenbrock_work), cudaMemcpyDeviceToHost));
+  cutilSafeCall(cudaFree(twork.k));
+  cutilSafeCall(cudaFree(twork.f0));
+  cutilSafeCall(cudaFree(twork.fstage));
+  cutilSafeCall(cudaFree(twork.dfdt));
+  cutilSafeCall(cudaFree(twork.temp));
+  cutilSafeCall(cudaFree(twork.jacobian));
+  cutilSafeCall(cudaFree(twork.lu));
+  cutilSafeCall(cudaFree(twork.pivots));
+  cutilSafeCall(cudaFree(work));
+#else
+  free(work->k);
+  free(work->f0);
+  free(work->fstage);
+  free(work->dfdt);
+  free(work->temp);
+  free(work->jacobian);
+  free(work->lu);
+  free(work->pivots);
+  free(work);
+#endif
+}
+
+__DEVICE__ void rosenbrock_tableau_init(unsigned int method, rosenbrock_tableau *tab){
+  switch(method){
+  case ROSENBROCK_RODAS3:
+    tab->stages = 4;
+    tab->order = 3;
+    tab->new_f[0] = 1; tab->new_f[1] = 0; tab->new_f[2] = 1; tab->new_f[3] = 1;
+    tab->a[0] = 0; tab->a[1] = 2; tab->a[2] = 0; tab->a[3] = 2; tab->a[4] = 0; tab->a[5] = 1;
+    tab->c[0] = 4; tab->c[1] = 1; tab->c[2] = -1; tab->c[3] = 1; tab->c[4] = -1; tab->c[5] = -FLITERAL(8.0)/3;
+    tab->m[0] = 2; tab->m[1] = 0; tab->m[2] = 1; tab->m[3] = 1;
+    tab->e[0] = 0; tab->e[1] = 0; tab->e[2] = 0; tab->e[3] = 1;
+    tab->alpha[0] = 0; tab->alpha[1] = 0; tab->alpha[2] = 1; tab->alpha[3] = 1;
+    tab->gamma[0] = FLITERAL(0.5); tab->gamma[1] = FLITERAL(1.5); tab->gamma[2] = 0; tab->gamma[3] = 0;
+    break;
+  case ROSENBROCK_ROS3:
+  default:
+    tab->stages = 3;
+    tab->order = 3;
+    tab->new_f[0] = 1; tab->new_f[1] = 1; tab->new_f[2] = 0;
+    tab->a[0] = 1; tab->a[1] = 1; tab->a[2] = 0;
+    tab->c[0] = FLITERAL(-1.0156171083877702091975600115545);
+    tab->c[1] = FLITERAL(4.0759956452537699824805835358067);
+    tab->c[2] = FLITERAL(9.2076794298330791242156818474003);
+    tab->m[0] = 1;
+    tab->m[1] = FLITERAL(6.1697947043828245592553615689730);
+    tab->m[2] = FLITERAL(-0.42772256543218573326238373806514);
+    tab->e[0] = FLITERAL(0.5);
+    tab->e[1] = FLITERAL(-2.9079558716805469821718236208017);
+    tab->e[2] = FLITERAL(0.22354069897811569627360909276199);
+    tab->alpha[0] = 0;
+    tab->alpha[1] = FLITERAL(0.43586652150845899941601945119356);
+    tab->alpha[2] = FLITERAL(0.43586652150845899941601945119356);
+    tab->gamma[0] = FLITERAL(0.43586652150845899941601945119356);
+    tab->gamma[1] = FLITERAL(0.24291996454816804366592249683314);
+    tab->gamma[2] = FLITERAL(2.1851380027664058511513169485832);
+    break;
+  }
+}
+
+// Approximates the Jacobian of the flows at the beginning of the step by forward differences
+// about f0, along with the time derivative of the flows.
+__DEVICE__ int rosenbrock_jacobian(solver_props *props, rosenbrock_work *work, unsigned int modelid){
+  int i;
+  unsigned int j, n = props->statesize;
+  int ret = 0;
+  CDATAFORMAT delta, yj;
+  CDATAFORMAT t = props->time[modelid];
+  CDATAFORMAT *df = work->k;
+
+  for(j=0; j<n; j++){
+    yj = props->model_states[VEC_IDX(n, j, PARALLEL_MODELS, modelid)];
+    delta = ROSENBROCK_JACOBIAN_DELTA*MAX(fabs(yj), FLITERAL(1e-5));
+    props->model_states[VEC_IDX(n, j, PARALLEL_MODELS, modelid)] = yj + delta;
+    ret |= model_flows(t, props->model_states, df, props, 0, modelid);
+    props->model_states[VEC_IDX(n, j, PARALLEL_MODELS, modelid)] = yj;
+
+    for(i=n-1; i>=0; i--) {
+      work->jacobian[MAT_IDX(n, n, i, j, PARALLEL_MODELS, modelid)] = (df[STATE_IDX] - work->f0[STATE_IDX])/delta;
+    }
+  }
+
+  delta = ROSENBROCK_JACOBIAN_DELTA*MAX(fabs(t), FLITERAL(1.0));
+  ret |= model_flows(t + delta, props->model_states, work->dfdt, props, 0, modelid);
+  for(i=n-1; i>=0; i--) {
+    work->dfdt[STATE_IDX] = (work->dfdt[STATE_IDX] - work->f0[STATE_IDX])/delta;
+  }
+
+  return ret;
+}
+
+// Forms and factors the iteration matrix I/(h*gamma) - J by Gaussian elimination with
+// partial pivoting.  Returns nonzero if the matrix is singular.
+__DEVICE__ int rosenbrock_factor(solver_props *props, rosenbrock_work *work, CDATAFORMAT hgamma_inv, unsigned int modelid){
+  unsigned int n = props->statesize;
+  unsigned int r, c, p, k;
+  CDATAFORMAT *M = work->lu;
+  CDATAFORMAT pivot, mult, swap;
+
+  for(r=0; r<n; r++){
+    for(c=0; c<n; c++){
+      M[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)] = -work->jacobian[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)];
+    }
+    M[MAT_IDX(n, n, r, r, PARALLEL_MODELS, modelid)] += hgamma_inv;
+  }
+
+  for(k=0; k<n; k++){
+    // Choose the largest remaining entry of the column as the pivot
+    p = k;
+    for(r=k+1; r<n; r++){
+      if(fabs(M[MAT_IDX(n, n, r, k, PARALLEL_MODELS, modelid)]) > fabs(M[MAT_IDX(n, n, p, k, PARALLEL_MODELS, modelid)]))
+	p = r;
+    }
+    work->pivots[VEC_IDX(n, k, PARALLEL_MODELS, modelid)] = p;
+    pivot = M[MAT_IDX(n, n, p, k, PARALLEL_MODELS, modelid)];
+    if(0 == pivot) return 1;
+    if(p != k){
+      for(c=0; c<n; c++){
+	swap = M[MAT_IDX(n, n, k, c, PARALLEL_MODELS, modelid)];
+	M[MAT_IDX(n, n, k, c, PARALLEL_MODELS, modelid)] = M[MAT_IDX(n, n, p, c, PARALLEL_MODELS, modelid)];
+	M[MAT_IDX(n, n, p, c, PARALLEL_MODELS, modelid)] = swap;
+      }
+    }
+    for(r=k+1; r<n; r++){
+      mult = M[MAT_IDX(n, n, r, k, PARALLEL_MODELS, modelid)]/pivot;
+      M[MAT_IDX(n, n, r, k, PARALLEL_MODELS, modelid)] = mult;
+      if(0 != mult){
+	for(c=k+1; c<n; c++){
+	  M[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)] -= mult*M[MAT_IDX(n, n, k, c, PARALLEL_MODELS, modelid)];
+	}
+      }
+    }
+  }
+
+  return 0;
+}
+
+// Solves the factored system in place for the right hand side b_x
+__DEVICE__ void rosenbrock_solve(solver_props *props, rosenbrock_work *work, CDATAFORMAT *b_x, unsigned int modelid){
+  unsigned int n = props->statesize;
+  unsigned int r, c, p;
+  int ri;
+  CDATAFORMAT *M = work->lu;
+  CDATAFORMAT sum, swap;
+
+  // Forward substitution with the unit lower triangle, applying the row interchanges
+  for(r=0; r<n; r++){
+    p = work->pivots[VEC_IDX(n, r, PARALLEL_MODELS, modelid)];
+    if(p != r){
+      swap = b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)];
+      b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] = b_x[VEC_IDX(n, p, PARALLEL_MODELS, modelid)];
+      b_x[VEC_IDX(n, p, PARALLEL_MODELS, modelid)] = swap;
+    }
+    sum = b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)];
+    for(c=0; c<r; c++){
+      sum -= M[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)]*b_x[VEC_IDX(n, c, PARALLEL_MODELS, modelid)];
+    }
+    b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] = sum;
+  }
+
+  // Back substitution with the upper triangle
+  for(ri=n-1; ri>=0; ri--){
+    r = ri;
+    sum = b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)];
+    for(c=r+1; c<n; c++){
+      sum -= M[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)]*b_x[VEC_IDX(n, c, PARALLEL_MODELS, modelid)];
+    }
+    b_x[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] = sum/M[MAT_IDX(n, n, r, r, PARALLEL_MODELS, modelid)];
+  }
+}
+
+// Returned by rosenbrock_step when the iteration matrix is singular and no step was taken
+#define ROSENBROCK_SINGULAR 2
+
+// Takes a single step of size h from props->model_states into props->next_states using the
+// Jacobian and flows already held in work.  The weighted RMS norm of the embedded error
+// estimate is written to norm.  A singular iteration matrix leaves next_states unwritten and
+// returns ROSENBROCK_SINGULAR.
+__DEVICE__ int rosenbrock_step(solver_props *props, rosenbrock_work *work, rosenbrock_tableau *tab, CDATAFORMAT h, CDATAFORMAT *norm, unsigned int modelid){
+  int i;
+  unsigned int s, j, idx;
+  unsigned int stride = props->statesize*PARALLEL_MODELS;
+  CDATAFORMAT err, max_allowed_error, err_sum;
+  CDATAFORMAT *ks, *kj, *fs;
+  int ret = 0;
+
+  if(rosenbrock_factor(props, work, 1/(h*tab->gamma[0]), modelid)){
+    *norm = 2;
+    return ROSENBROCK_SINGULAR;
+  }
+
+  fs = work->f0;
+  for(s=0; s<tab->stages; s++){
+    ks = work->k + s*stride;
+    idx = s*(s-1)/2;
+
+    // Stages that do not evaluate the flows reuse those of the previous stage
+    if(s > 0 && tab->new_f[s]){
+      for(i=props->statesize-1; i>=0; i--) {
+	work->temp[STATE_IDX] = props->model_states[STATE_IDX];
+      }
+      for(j=0; j<s; j++){
+	kj = work->k + j*stride;
+	for(i=props->statesize-1; i>=0; i--) {
+	  work->temp[STATE_IDX] += tab->a[idx+j]*kj[STATE_IDX];
+	}
+      }
+      ret |= model_flows(props->time[modelid] + tab->alpha[s]*h, work->temp, work->fstage, props, 0, modelid);
+      fs = work->fstage;
+    }
+
+    for(i=props->statesize-1; i>=0; i--) {
+      ks[STATE_IDX] = fs[STATE_IDX] + h*tab->gamma[s]*work->dfdt[STATE_IDX];
+    }
+    for(j=0; j<s; j++){
+      kj = work->k + j*stride;
+      for(i=props->statesize-1; i>=0; i--) {
+	ks[STATE_IDX] += (tab->c[idx+j]/h)*kj[STATE_IDX];
+      }
+    }
+
+    rosenbrock_solve(props, work, ks, modelid);
+  }
+
+  for(i=props->statesize-1; i>=0; i--) {
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX];
+    work->temp[STATE_IDX] = 0;
+  }
+  for(s=0; s<tab->stages; s++){
+    ks = work->k + s*stride;
+    for(i=props->statesize-1; i>=0; i--) {
+      props->next_states[STATE_IDX] += tab->m[s]*ks[STATE_IDX];
+      work->temp[STATE_IDX] += tab->e[s]*ks[STATE_IDX];
+    }
+  }
+
+  err_sum = 0;
+  for(i=props->statesize-1; i>=0; i--) {
+    err = work->temp[STATE_IDX];
+    max_allowed_error = props->reltol*MAX(fabs(props->next_states[STATE_IDX]),fabs(props->model_states[STATE_IDX]))+props->abstol;
+    err_sum += (err/max_allowed_error)*(err/max_allowed_error);
+  }
+  *norm = sqrt(err_sum/((CDATAFORMAT)props->statesize));
+
+  return ret;
+}
+
+// Attempts a step of size h and decides whether it is accepted.  A step on a singular iteration
+// matrix is rejected so that a smaller one is tried; at the minimum timestep it is an error.
+__DEVICE__ int rosenbrock_attempt(solver_props *props, rosenbrock_work *work, rosenbrock_tableau *tab, CDATAFORMAT h, CDATAFORMAT *norm, int *accepted, unsigned int modelid){
+  int ret = rosenbrock_step(props, work, tab, h, norm, modelid);
+
+  if(ROSENBROCK_SINGULAR == ret){
+    *accepted = 0;
+    props->stats[modelid].rejected++;
+    if(h <= props->timestep/STEP_RANGE){
+      PRINTF("Singular iteration matrix at the minimum timestep in model %d.\n", modelid);
+      return 1;
+    }
+    return 0;
+  }
+
+  *accepted = step_control_accept(props, h, *norm, modelid);
+  return ret;
+}
+
+#define ROSENBROCK_POWER_ITERATIONS 8
+
+// Estimates the spectral radius of the Jacobian held in work by power iteration.  Overwrites
+// the fstage and temp vectors of work.
+__DEVICE__ CDATAFORMAT rosenbrock_spectral_radius(solver_props *props, rosenbrock_work *work, unsigned int modelid){
+  unsigned int n = props->statesize;
+  unsigned int r, c, iter;
+  CDATAFORMAT *v = work->temp;
+  CDATAFORMAT *w = work->fstage;
+  CDATAFORMAT *swap;
+  CDATAFORMAT sum, norm, radius = 0;
+
+  for(r=0; r<n; r++){
+    v[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] = 1/sqrt((CDATAFORMAT)n);
+  }
+
+  for(iter=0; iter<ROSENBROCK_POWER_ITERATIONS; iter++){
+    norm = 0;
+    for(r=0; r<n; r++){
+      sum = 0;
+      for(c=0; c<n; c++){
+	sum += work->jacobian[MAT_IDX(n, n, r, c, PARALLEL_MODELS, modelid)]*v[VEC_IDX(n, c, PARALLEL_MODELS, modelid)];
+      }
+      w[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] = sum;
+      norm += sum*sum;
+    }
+    radius = sqrt(norm);
+    if(0 == radius) break;
+    for(r=0; r<n; r++){
+      w[VEC_IDX(n, r, PARALLEL_MODELS, modelid)] /= radius;
+    }
+    swap = v; v = w; w = swap;
+  }
+
+  return radius;
+}
+
+// Event location
+// ============================================================================================================
+#if NUM_EVENT_GUARDS > 0
+
+// Each relational condition of an update equation is written by the update flows as a guard function
+// which is positive while its condition holds.  Guards are stored in the order of evaluation by
+// EVENT_GUARD(), see event_guards.h.
+__DEVICE__ CDATAFORMAT event_guards[NUM_EVENT_GUARDS*PARALLEL_MODELS];
+__DEVICE__ unsigned int event_guard_count[PARALLEL_MODELS];
+
+#define EVENT_IDX TARGET_IDX(NUM_EVENT_GUARDS, PARALLEL_MODELS, j, modelid)
+
+// Events are located to within this fraction of the simulation time
+#if defined SIMENGINE_STORAGE_float
+#define EVENT_TIME_TOLERANCE 1e-5f
+#else
+#define EVENT_TIME_TOLERANCE 1e-10
+#endif
+#define EVENT_MAX_ITERATIONS 50
+
+// Working space of a variable timestep solver for locating events
+typedef struct {
+  CDATAFORMAT *y; // Interpolated states
+  CDATAFORMAT *scratch; // Discarded results of the update iterator
+  CDATAFORMAT *time; // Time at which the guards are evaluated
+  CDATAFORMAT *g0; // Guards at the low end of the bracket
+  CDATAFORMAT *g1; // Guards at the high end of the bracket
+  CDATAFORMAT *g; // Guards at the interior estimate
+} solver_events;
+
+__HOST__ solver_events *solver_events_init(solver_props *props){
+  unsigned int statesize = props->statesize + props->algebraic_statesize;
+#if defined TARGET_GPU
+  solver_events tevents;
+  solver_events *devents;
+
+  cutilSafeCall(cudaMalloc((void**)&devents, sizeof(solver_events)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.y, statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.scratch, statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.time, PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.g0, NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.g1, NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tevents.g, NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMemcpy(devents, &tevents, sizeof(solver_events), cudaMemcpyHostToDevice));
+
+  return devents;
+#else
+  solver_events *events = (solver_events*)malloc(sizeof(solver_events));
+
+  events->y = (CDATAFORMAT*)malloc(statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  events->scratch = (CDATAFORMAT*)malloc(statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  events->time = (CDATAFORMAT*)malloc(PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  events->g0 = (CDATAFORMAT*)malloc(NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  events->g1 = (CDATAFORMAT*)malloc(NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  events->g = (CDATAFORMAT*)malloc(NUM_EVENT_GUARDS*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+
+  return events;
+#endif
+}
+
+__HOST__ void solver_events_free(solver_events *events){
+#if defined TARGET_GPU
+  solver_events tevents;
+
+  cutilSafeCall(cudaMemcpy(&tevents, events, sizeof(solver_events), cudaMemcpyDeviceToHost));
+  cutilSafeCall(cudaFree(tevents.y));
+  cutilSafeCall(cudaFree(tevents.scratch));
+  cutilSafeCall(cudaFree(tevents.time));
+  cutilSafeCall(cudaFree(tevents.g0));
+  cutilSafeCall(cudaFree(tevents.g1));
+  cutilSafeCall(cudaFree(tevents.g));
+  cutilSafeCall(cudaFree(events));
+#else
+  free(events->y);
+  free(events->scratch);
+  free(events->time);
+  free(events->g0);
+  free(events->g1);
+  free(events->g);
+  free(events);
+#endif
+}
+
+// Evaluates the event guards for the states y at time t by running the update iterator
+// on a private copy of the solver properties.  Neither the states nor the time are altered.
+// Returns the number of guards written.
+__DEVICE__ unsigned int solver_event_guards(solver_props *props, solver_events *events, CDATAFORMAT t, CDATAFORMAT *y, CDATAFORMAT *g, unsigned int modelid){
+  unsigned int j;
+  solver_props probe = *props;
+
+  events->time[modelid] = t;
+  probe.next_time = events->time;
+  probe.model_states = y;
+  probe.next_states = events->scratch;
+
+  event_guard_count[modelid] = 0;
+  update(&probe, modelid);
+
+  for(j=0; j<event_guard_count[modelid]; j++){
+    g[EVENT_IDX] = event_guards[EVENT_IDX];
+  }
+
+  return event_guard_count[modelid];
+}
+
+// Cubic Hermite interpolation of the states at a fraction theta of a step of size h
+// from the states and flows at either end of the step.
+__DEVICE__ void solver_dense_output(solver_props *props, CDATAFORMAT theta, CDATAFORMAT h, CDATAFORMAT *y0, CDATAFORMAT *dydt0, CDATAFORMAT *y1, CDATAFORMAT *dydt1, CDATAFORMAT *y, unsigned int modelid){
+  int i;
+  CDATAFORMAT theta2 = theta*theta;
+  CDATAFORMAT theta3 = theta2*theta;
+  CDATAFORMAT h00 = 2*theta3 - 3*theta2 + 1;
+  CDATAFORMAT h10 = (theta3 - 2*theta2 + theta)*h;
+  CDATAFORMAT h01 = 3*theta2 - 2*theta3;
+  CDATAFORMAT h11 = (theta3 - theta2)*h;
+
+  for(i=props->statesize-1; i>=0; i--) {
+    y[STATE_IDX] = h00*y0[STATE_IDX] + h10*dydt0[STATE_IDX] + h01*y1[STATE_IDX] + h11*dydt1[STATE_IDX];
+  }
+}
+
+// Locates the earliest event within an accepted step of size h beginning at props->time.
+// An event occurs where a guard crosses from nonpositive to positive, i.e. where an update
+// condition becomes true.  The crossing is bracketed on the dense output of the step and
+// refined by the Illinois variant of regula falsi.  When an event is found, next_states is
+// replaced by the interpolated states just past the crossing, so that the update iterator
+// applies its reset at the time of the event, and the truncated step is returned.
+// Otherwise h is returned and next_states is left untouched.
+__DEVICE__ CDATAFORMAT solver_locate_event(solver_props *props, solver_events *events, CDATAFORMAT h, CDATAFORMAT *dydt0, CDATAFORMAT *dydt1, unsigned int modelid){
+  unsigned int j, n, iteration;
+  int side = 0;
+  int crossed = 0;
+  CDATAFORMAT t = props->time[modelid];
+  CDATAFORMAT tolerance = EVENT_TIME_TOLERANCE*(fabs(t) + fabs(h))/h;
+  CDATAFORMAT a = 0, b = 1, theta, alpha = 1;
+
+  // Guards at the start of the step are evaluated after any preceding reset
+  n = solver_event_guards(props, events, t, props->model_states, events->g0, modelid);
+  if (0 == n) return h;
+  solver_event_guards(props, events, t+h, props->next_states, events->g1, modelid);
+
+  for(j=0; j<n; j++){
+    crossed |= events->g0[EVENT_IDX] <= 0 && events->g1[EVENT_IDX] > 0;
+  }
+  if (!crossed) return h;
+
+  for(iteration=0; iteration<EVENT_MAX_ITERATIONS && b - a > tolerance; iteration++){
+    // Secant estimate of the earliest crossing.  The weight alpha implements the Illinois
+    // modification, discounting an end of the bracket that has been retained repeatedly.
+    theta = b;
+    for(j=0; j<n; j++){
+      if (events->g0[EVENT_IDX] <= 0 && events->g1[EVENT_IDX] > 0) {
+	CDATAFORMAT estimate = b - events->g1[EVENT_IDX]*(b - a)/(events->g1[EVENT_IDX] - alpha*events->g0[EVENT_IDX]);
+	theta = estimate < theta ? estimate : theta;
+      }
+    }
+    // Keep the estimate strictly within the bracket
+    if (theta < a + tolerance/2) theta = a + tolerance/2;
+    if (theta > b - tolerance/2) theta = b - tolerance/2;
+
+    solver_dense_output(props, theta, h, props->model_states, dydt0, props->next_states, dydt1, events->y, modelid);
+    solver_event_guards(props, events, t+theta*h, events->y, events->g, modelid);
+
+    crossed = 0;
+    for(j=0; j<n; j++){
+      crossed |= events->g0[EVENT_IDX] <= 0 && events->g[EVENT_IDX] > 0;
+    }
+    if (crossed) {
+      b = theta;
+      for(j=0; j<n; j++) events->g1[EVENT_IDX] = events->g[EVENT_IDX];
+      alpha = side == 1 ? alpha/2 : 1;
+      side = 1;
+    }
+    else {
+      a = theta;
+      for(j=0; j<n; j++) events->g0[EVENT_IDX] = events->g[EVENT_IDX];
+      alpha = side == -1 ? alpha*2 : 1;
+      side = -1;
+    }
+  }
+
+  if (b < 1) {
+    solver_dense_output(props, b, h, props->model_states, dydt0, props->next_states, dydt1, props->next_states, modelid);
+  }
+
+  return b*h;
+}
+
+#endif // NUM_EVENT_GUARDS > 0
+
 #endif // SOLVERS_H
@@ -0,0 +1,134 @@
+// Stochastic Runge-Kutta (weak order 2) Integration Method
+// Explicit weak order 2 scheme of Platen for stochastic differential equations with diagonal
+// noise (Kloeden and Platen, 15.1.1).  Suited to estimating moments and distributions over
+// many instances, where it permits much larger steps than Euler-Maruyama.
+// Copyright 2009, 2010 Simatra Modeling Technologies, L.L.C.
+
+typedef struct {
+  CDATAFORMAT *f; // Drift
+  CDATAFORMAT *g; // Diffusion
+  CDATAFORMAT *dW; // Wiener increments
+  CDATAFORMAT *temp; // Supporting value
+  CDATAFORMAT *k; // Drift at a supporting value
+  CDATAFORMAT *gp; // Diffusion at the upper supporting value
+  CDATAFORMAT *gm; // Diffusion at the lower supporting value
+} srk2_mem;
+
+__HOST__
+int srk2_init(solver_props *props){
+#if defined TARGET_GPU
+  // Temporary CPU copies of GPU datastructures
+  srk2_mem tmem;
+  // GPU datastructures
+  srk2_mem *dmem;
+  
+  // Allocate GPU space for mem and pointer fields of mem (other than props)
+  cutilSafeCall(cudaMalloc((void**)&dmem, sizeof(srk2_mem)));
+  props->mem = dmem;
+  cutilSafeCall(cudaMalloc((void**)&tmem.f, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.g, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.dW, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.temp, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.k, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.gp, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+  cutilSafeCall(cudaMalloc((void**)&tmem.gm, props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT)));
+
+  // Copy mem structure to GPU
+  cutilSafeCall(cudaMemcpy(dmem, &tmem, sizeof(srk2_mem), cudaMemcpyHostToDevice));
+
+#else // Used for CPU and OPENMP targets
+
+  srk2_mem *mem = (srk2_mem*)malloc(sizeof(srk2_mem));
+
+  props->mem = mem;
+  mem->f = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->g = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->dW = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->temp = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->k = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->gp = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+  mem->gm = (CDATAFORMAT*)malloc(props->statesize*PARALLEL_MODELS*sizeof(CDATAFORMAT));
+#endif
+
+  return 0;
+}
+
+__DEVICE__
+int srk2_eval(solver_props *props, unsigned int modelid){
+  int i;
+  int ret;
+  CDATAFORMAT h = props->timestep;
+  CDATAFORMAT sqrt_h = sqrt(h);
+  CDATAFORMAT t = props->time[modelid];
+
+  srk2_mem *mem = (srk2_mem*)props->mem;
+
+  ret = solver_drift_diffusion(props, t, props->model_states, mem->f, mem->g, 1, modelid);
+  solver_wiener_increments(props, h, mem->dW, modelid);
+
+  // Diffusion at the supporting values y + f h +/- g sqrt(h)
+  for(i=props->statesize-1; i>=0; i--) {
+    mem->temp[STATE_IDX] = props->model_states[STATE_IDX] +
+      h * mem->f[STATE_IDX] + sqrt_h * mem->g[STATE_IDX];
+  }
+  ret |= solver_drift_diffusion(props, t+h, mem->temp, mem->k, mem->gp, 0, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    mem->temp[STATE_IDX] = props->model_states[STATE_IDX] +
+      h * mem->f[STATE_IDX] - sqrt_h * mem->g[STATE_IDX];
+  }
+  ret |= solver_drift_diffusion(props, t+h, mem->temp, mem->k, mem->gm, 0, modelid);
+
+  // Drift at the Euler-Maruyama predictor
+  for(i=props->statesize-1; i>=0; i--) {
+    mem->temp[STATE_IDX] = props->model_states[STATE_IDX] +
+      h * mem->f[STATE_IDX] + mem->g[STATE_IDX] * mem->dW[STATE_IDX];
+  }
+  ret |= model_flows(t+h, mem->temp, mem->k, props, 0, modelid);
+
+  for(i=props->statesize-1; i>=0; i--) {
+    CDATAFORMAT dW = mem->dW[STATE_IDX];
+    props->next_states[STATE_IDX] = props->model_states[STATE_IDX] +
+      (h/2) * (mem->k[STATE_IDX] + mem->f[STATE_IDX]) +
+      (dW/4) * (mem->gp[STATE_IDX] + mem->gm[STATE_IDX] + 2*mem->g[STATE_IDX]) +
+      (mem->gp[STATE_IDX] - mem->gm[STATE_IDX]) * (dW*dW - h) / (4*sqrt_h);
+  }
+
+  solver_step_time(props, h, modelid);
+
+  return ret;
+}
+
+__HOST__
+int srk2_free(solver_props *props){
+#if defined TARGET_GPU
+  srk2_mem *dmem = (srk2_mem*)props->mem;
+  srk2_mem tmem;
+
+  cutilSafeCall(cudaMemcpy(&tmem, dmem, sizeof(srk2_mem), cudaMemcpyDeviceToHost));
+
+  cutilSafeCall(cudaFree(tmem.f));
+  cutilSafeCall(cudaFree(tmem.g));
+  cutilSafeCall(cudaFree(tmem.dW));
+  cutilSafeCall(cudaFree(tmem.temp));
+  cutilSafeCall(cudaFree(tmem.k));
+  cutilSafeCall(cudaFree(tmem.gp));
+  cutilSafeCall(cudaFree(tmem.gm));
+  cutilSafeCall(cudaFree(dmem));
+
+#else // Used for CPU and OPENMP targets
+
+  srk2_mem *mem =(srk2_mem*)props->mem;
+
+  free(mem->f);
+  free(mem->g);
+  free(mem->dW);
+  free(mem->temp);
+  free(mem->k);
+  free(mem->gp);
+  free(mem->gm);
+  free(mem);
+#endif // defined TARGET_GPU
+
+  return 0;
+}
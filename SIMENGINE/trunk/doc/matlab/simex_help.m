@@ -49,6 +49,9 @@
 % |SIMEX(DSL, TIME, '-float', ...)| Constructs a simulation engine that computes in
 % lower-precision floating point.
 %
+% |SIMEX(DSL, TIME, '-mixed', ...)| Constructs a simulation engine that stores states in
+% lower-precision floating point but accumulates solver steps and time in double precision.
+%
 % |SIMEX(DSL, TIME, '-gpu', ...)| Constructs a parallel simulation engine capable of
 % executing on a GPU.
 %
@@ -45,7 +45,8 @@ classdef Iterator < handle
     
     properties (GetAccess = public, SetAccess = private)
         solvers = {'forwardeuler', 'linearbackwardeuler', ...
-                   'exponentialeuler', 'auto', 'heun', 'rk4', 'cvode', 'ode23', 'ode45'};
+                   'exponentialeuler', 'auto', 'heun', 'rk4', 'cvode', 'ode23', 'ode45', ...
+                   'ros3', 'rodas3', 'autostiff', 'multirate', 'eulermaruyama', 'milstein', 'srk2'};
     end
     
     methods (Static)
@@ -85,7 +86,29 @@ classdef Iterator < handle
             %   'linearbackwardeuler' - 1st-order backward Euler scheme
             %   usable on states that are linear in relationship to each
             %   other.
+            %   'ros3' - 3rd-order linearly implicit variable time step
+            %   Rosenbrock method for stiff problems
+            %   'rodas3' - 3rd-order stiffly accurate Rosenbrock method
+            %   suited to very stiff problems
+            %   'autostiff' - variable time step solver which switches each
+            %   model instance between 'ode45' and 'ros3' as its solution
+            %   becomes nonstiff or stiff
+            %   'multirate' - 4th-order Runga-Kutta method which steps
+            %   states that are slower than the fastest state by at least a
+            %   factor of 'mr_ratio' (default 10) only once every 'mr_ratio'
+            %   steps
             %   'cvode' - calls the CVode solver developed under SUNDIALS.
+            %   'eulermaruyama' - 1st-order explicit method for equations
+            %   driven by wiener() noise
+            %   'milstein' - strong 1st-order method for equations driven
+            %   by wiener() noise
+            %   'srk2' - weak 2nd-order stochastic Runge-Kutta method for
+            %   equations driven by wiener() noise
+            %
+            %   The variable time step solvers 'ode23', 'ode45', 'ros3',
+            %   'rodas3' and 'autostiff' bound the change of the time step
+            %   within a single adjustment by the factors 'min_factor'
+            %   (default 0.2) and 'max_factor' (default 5).
             %
             % Examples:
             %   t_implicit = Iterator('continuous', 'solver',
@@ -93,6 +116,9 @@ classdef Iterator < handle
             %
             %   t_accurate = Iterator('continuous', 'solver', 'ode45',
             %   'reltol', 1e-8, 'abstol', 1e-8);
+            %
+            %   t_smooth = Iterator('continuous', 'solver', 'ode45',
+            %   'min_factor', 0.5, 'max_factor', 2);
             %   t_cvode = Iterator('continuous', 'solver', 'cvode');
             %
             %   n = Iterator('discrete', 'sample_frequency', 8192);
@@ -288,6 +314,20 @@ classdef Iterator < handle
                                         m.params('sample_period') = 1/val;
                                     end
                                     
+                                case {'min_factor', 'max_factor'}
+                                    if ~isnumeric(val) || val <= 0
+                                        error(['Simatra:Iterator:' key], ['The value passed for ' key ' must be greater than zero']);
+                                    elseif strcmp(key, 'min_factor') && val > 1
+                                        error('Simatra:Iterator:min_factor', 'The value passed for min_factor must be no greater than one');
+                                    elseif strcmp(key, 'max_factor') && val < 1
+                                        error('Simatra:Iterator:max_factor', 'The value passed for max_factor must be no less than one');
+                                    end
+                                    
+                                case {'mr_ratio'}
+                                    if ~isnumeric(val) || val < 1 || val ~= round(val)
+                                        error('Simatra:Iterator:mr_ratio', 'The value passed for mr_ratio must be a positive integer');
+                                    end
+                                    
                                 case {'cv_lmm'}
                                     if ~ischar(val)
                                         error('Simatra:Iterator:cv_lmm', 'The value passed in for cv_lmm must be a string (one of CV_ADAMS or CV_BDF)');
@@ -365,12 +405,18 @@ classdef Iterator < handle
             else % else if is continuous
                 switch iter.solver
                     case {'forwardeuler', 'linearbackwardeuler', ...
-                          'exponentialeuler', 'rk4', 'heun', 'auto'}
+                          'exponentialeuler', 'rk4', 'heun', 'auto', ...
+                          'eulermaruyama', 'milstein', 'srk2'}
                         iter.params('dt') = 1;
-                    case {'ode23', 'ode45'}
+                    case {'ode23', 'ode45', 'ros3', 'rodas3', 'autostiff'}
                         iter.params('dt') = 1;
                         iter.params('reltol') = 1e-3;
                         iter.params('abstol') = 1e-6;
+                        iter.params('min_factor') = 0.2;
+                        iter.params('max_factor') = 5;
+                    case {'multirate'}
+                        iter.params('dt') = 1;
+                        iter.params('mr_ratio') = 10;
                     case {'cvode'}
                         iter.params('dt') = 1;
                         iter.params('cv_lmm') = 'CV_BDF';
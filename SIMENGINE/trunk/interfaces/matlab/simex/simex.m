@@ -47,6 +47,11 @@ function [varargout] = simex(dsl, varargin)
 %         Constructs a simulation engine that computes in
 %         lower-precision floating point.
 %
+%       '-mixed'
+%         Constructs a simulation engine that stores states in
+%         lower-precision floating point but accumulates solver
+%         steps and time in double precision.
+%
 %       '-gpu'
 %         Constructs a parallel simulation engine capable of
 %         executing on a GPU.
@@ -199,6 +199,9 @@ function [options, restUserOptions] = getOption(options, userOptions)
     case {'float','single'}
       options.precision = 'float';
       options.args = [options.args ' --precision float'];
+    case 'mixed'
+      options.precision = 'mixed';
+      options.args = [options.args ' --precision mixed'];
     case 'gpu'
       options.target = 'gpu';
     case 'cpu'
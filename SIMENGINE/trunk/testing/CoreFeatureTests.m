@@ -31,6 +31,7 @@ s.add(ConstantFeatureTests(target));
 s.add(IntermediateFeatureTests(mode, target));
 s.add(FunctionFeatureTests(target));
 s.add(DifferenceEquationTests(target));
+s.add(CompilationCacheTests(target));
 
 end
 
@@ -100,6 +101,13 @@ s.add(Test('TestFinalStates', @TestFinalStates));
         y = equiv(tf, 10);
     end
 s.add(Test('TestFinalTime', @TestFinalTime));
+    % x decays below the default tolerances of the fixed step solvers by t = 14, after which the
+    % instance stops at its steady state rather than at the stop time
+    function y = TestSteadyStateTime
+        [o, finalStates, tf] = simex('models_FeatureTests/SteadyStateTest1.dsl', 100, '-steady_state', 10, target);
+        y = tf > 10 && tf < 20 && abs(finalStates) < 1e-5 && equiv(o.x(end,1), tf);
+    end
+s.add(Test('TestSteadyStateTime', @TestSteadyStateTime));
 s.add(Test('StateWithoutEquation', @()(simex('models_FeatureTests/StateTest2.dsl', 10, target)), '-equal', struct('x', [0:10; 1:11]', 'y', [0:10; 5*ones(1,11)]')));
 s.add(Test('MultilineEquations (zero states)', @()(simex('models_FeatureTests/StateTest3.dsl', 10, target)), '-withouterror'))
 s.add(Test('InitValueasConstant', @()(simex('models_FeatureTests/StateTest5.dsl', 10, '-resume', [1], target)), '-equal', struct('x', [0:10; 1:11]')));
@@ -178,6 +186,17 @@ s.add(Test('InputToOutput', ...
 s.add(Test('InputFcnOfTime', ...
            @()(simex(['models_FeatureTests/IntermediateTest5.dsl'], 10, target)), ...
            '-equal', struct('y', [0:10; [zeros(1,6) 1:5]]', 'I', [0:10; [zeros(1,5) ones(1,6)]]')));
+c = exp(4/10) * sqrt(5);
+s.add(Test('IntermediateOfInputs', ...
+           @()(simex(['models_FeatureTests/IntermediateTest6.dsl'], 10, struct('a', 4, 'b', 5), target)), ...
+           '-approxequal', struct('y', [0:10; c*(0:10); (c^2 + 20)*ones(1,11)]')));
+    function y = IntermediateOfInputsNotPrecomputed
+        inputs = struct('a', 4, 'b', 5);
+        o1 = simex('models_FeatureTests/IntermediateTest6.dsl', 10, inputs, target);
+        o2 = simex('models_FeatureTests/IntermediateTest6.dsl', 10, inputs, target, '-precompute=false');
+        y = approx_equiv(o1, o2, 1e-6);
+    end
+s.add(Test('IntermediateOfInputsNotPrecomputed', @IntermediateOfInputsNotPrecomputed));
 
 % We want to add derivative suport soon
 if mode == INTERNAL
@@ -218,6 +237,37 @@ outliers = [find(o.r1(:,2)<-10)' ...
 y = not(length(outliers) > 0);
 end
 s.add(Test('RandomOperations', @RandomTest));
+% The Philox streams are keyed by the seed and the instance, so a seed
+% reproduces every stream exactly while each instance draws its own
+    function y = RandomSeedReproducible
+        o1 = simex('models_FeatureTests/RandomTest1.dsl', 100, '-seed', 7, target);
+        o2 = simex('models_FeatureTests/RandomTest1.dsl', 100, '-seed', 7, target);
+        o3 = simex('models_FeatureTests/RandomTest1.dsl', 100, '-seed', 8, target);
+        y = equiv(o1, o2) && ~isequal(o1.r2, o3.r2);
+    end
+s.add(Test('RandomSeedReproducible', @RandomSeedReproducible));
+    function y = RandomInstanceStreams
+        o = simex('models_FeatureTests/RandomTest1.dsl', 100, '-seed', 7, ...
+                  '-instances', 4, target);
+        y = true;
+        for i = 1:length(o)
+            for j = i+1:length(o)
+                y = y && ~isequal(o(i).r2(:,2), o(j).r2(:,2));
+            end
+        end
+    end
+s.add(Test('RandomInstanceStreams', @RandomInstanceStreams));
+% Chi-squared test of 10000 uniform draws in 10 equal bins; the critical
+% value for 9 degrees of freedom at the 0.1% level is 27.88
+    function y = RandomUniformity
+        o = simex('models_FeatureTests/RandomTest1.dsl', 9999, '-seed', 7, target);
+        r = o.r2(:,2);
+        counts = histc(r, 0:10);
+        counts = [counts(1:9); counts(10) + counts(11)];
+        expected = length(r)/10;
+        y = all(r >= 0 & r <= 10) && sum((counts - expected).^2/expected) < 27.88;
+    end
+s.add(Test('RandomUniformity', @RandomUniformity));
 % TODO validate the statistical distributions
 s.add(Test('NormalDistribution', ...
            @()(simex(['models_FeatureTests/RandomTest2.dsl'], 2, target)), ...
@@ -225,6 +275,26 @@ s.add(Test('NormalDistribution', ...
 s.add(Test('MixedDistribution', ...
            @()(simex(['models_FeatureTests/RandomTest3.dsl'], 10, target)), ...
            '-withouterror'));
+% An Ornstein-Uhlenbeck process started at x0 has mean x0*exp(-theta*t)
+% and variance sigma^2/(2*theta)*(1-exp(-2*theta*t)); check the sample
+% moments over many independently seeded instances
+    function y = OrnsteinUhlenbeck
+        n = 1000; t = 2; theta = 1; sigma = 1;
+        o = simex('models_FeatureTests/StochasticTest3.dsl', t, '-instances', n, target);
+        x = arrayfun(@(oi)(oi.x(end,2)), o);
+        m = exp(-theta*t);
+        v = sigma^2/(2*theta)*(1-exp(-2*theta*t));
+        % five standard errors of each sample moment
+        y = abs(mean(x) - m) < 5*sqrt(v/n) && ...
+            abs(var(x) - v) < 5*v*sqrt(2/(n-1));
+    end
+s.add(Test('WienerNoise', @OrnsteinUhlenbeck));
+s.add(Test('WienerNoiseWithoutDiffusion', ...
+           @()(simex(['models_FeatureTests/StochasticTest1.dsl'], 1, struct('sigma', 0), target)), ...
+           '-equal', struct('x', [0:0.5:1; 1 0.5 0.25]')));
+s.add(Test('WienerNoiseWeakOrder2WithoutDiffusion', ...
+           @()(simex(['models_FeatureTests/StochasticTest2.dsl'], 1, struct('sigma', 0), target)), ...
+           '-equal', struct('x', [0:0.5:1; 1 0.625 0.390625]')));
 s.add(Test('FunctionModulus', @()(simex(['models_FeatureTests/' ...
                     'FunctionTestModulus.dsl'], 10, target)), '-equal', ...
            struct('y', [0:10; 0 1 0 1 0 1 0 1 0 1 0]')));
@@ -331,3 +401,75 @@ s.add(Test('Difference Equation of n', ...
            '-equal', struct('iter', [0:10; 0:10; [0 0:9]]')));
 
 end
+
+
+function s = CompilationCacheTests(target)
+
+s = Suite(['Compilation Cache Tests ' target]);
+
+s.add(Test('ReuseAfterTouch', @()(CacheAfterEdit(target, 2, 2))));
+s.add(Test('RecompileEditedShard', @()(CacheAfterEdit(target, 2, 3))));
+s.add(Test('UncreatableCacheDirectory', @()(UncreatableCache(target))));
+
+end
+
+% Compiles a copy of TemporalIteratorSubModelsTest2, whose iterators are written to
+% separate source files, then rewrites it with the step of its second submodel
+% changed from step to step2 and compiles it again.  Only the objects of an unchanged
+% model are all reused from the cache.
+function e = CacheAfterEdit(target, step, step2)
+    workdir = tempname;
+    mkdir(workdir);
+    model = fullfile(workdir, 'TemporalIteratorSubModelsTest2.dsl');
+    cacheopt = ['-cachedir=' fullfile(workdir, 'cache')];
+    WriteCacheModel(model, step);
+    [out1, o1] = evalc('simex(model, 10, target, ''-debug'', cacheopt)');
+    % The rewritten file must be newer than the compiled model
+    pause(1.1);
+    WriteCacheModel(model, step2);
+    [out2, o2] = evalc('simex(model, 10, target, ''-debug'', cacheopt)');
+    rmdir(workdir, 's');
+    reused = ~isempty(strfind(out2, 'Reusing cached object'));
+    compiled = ~isempty(strfind(out2, 'Compile: '));
+    e = isempty(strfind(out1, 'Reusing cached object')) && reused && ...
+        (compiled == (step ~= step2)) && ...
+        equiv(o2, struct('y1', [0:10; 0:10]', 'y2', [0:10; 0:step2:10*step2]'));
+    if step == step2
+        e = e && equiv(o1, o2);
+    end
+end
+
+% A cache directory which can't be created, here beneath a regular file, disables the cache
+function e = UncreatableCache(target)
+    file = [tempname '.txt'];
+    fid = fopen(file, 'w');
+    fclose(fid);
+    cacheopt = ['-cachedir=' fullfile(file, 'cache')];
+    [out, o] = evalc('simex(''models_FeatureTests/TemporalIteratorSubModelsTest2.dsl'', 10, target, ''-regenerateTimings'', ''-debug'', cacheopt)');
+    delete(file);
+    e = isempty(strfind(out, 'Reusing cached object')) && ...
+        equiv(o, struct('y1', [0:10; 0:10]', 'y2', [0:10; 0:2:20]'));
+end
+
+function WriteCacheModel(file, step)
+    fid = fopen(file, 'w');
+    fprintf(fid, 'model (x) = Sub1(step)\n');
+    fprintf(fid, '    iterator t1 with {continuous,solver=forwardeuler{dt=1}}\n');
+    fprintf(fid, '    state x = 0 with {iter=t1}\n');
+    fprintf(fid, '    equation x'' = step\n');
+    fprintf(fid, 'end\n');
+    fprintf(fid, 'model (x) = Sub2(step)\n');
+    fprintf(fid, '    iterator t2 with {continuous,solver=forwardeuler{dt=1}}\n');
+    fprintf(fid, '    state x = 0 with {iter=t2}\n');
+    fprintf(fid, '    equation x'' = step\n');
+    fprintf(fid, 'end\n');
+    fprintf(fid, 'model (y1,y2)=TemporalIteratorSubModelsTest2\n');
+    fprintf(fid, '    iterator t1 with {continuous,solver=forwardeuler{dt=1}}\n');
+    fprintf(fid, '    iterator t2 with {continuous,solver=forwardeuler{dt=1}}\n');
+    fprintf(fid, '    submodel Sub1 s1 with {step=1}\n');
+    fprintf(fid, '    submodel Sub2 s2 with {step=%g}\n', step);
+    fprintf(fid, '    output y1 = s1.x\n');
+    fprintf(fid, '    output y2 = s2.x\n');
+    fprintf(fid, 'end\n');
+    fclose(fid);
+end
@@ -131,6 +131,7 @@ s.add(Test('Strings', @()(0 == system([simpath ' DSLTests/difftests/strings.dsl
 s.add(Test('Booleans', @()(0 == system([simpath ' DSLTests/difftests/booleans.dsl | diff - DSLTests/difftests/booleans.ok']))));
 s.add(Test('Loops', @()(0 == system([simpath ' DSLTests/difftests/loops.dsl | diff - DSLTests/difftests/loops.ok']))));
 s.add(Test('Patterns', @()(0 == system([simpath ' DSLTests/difftests/patterns.dsl | diff - DSLTests/difftests/patterns.ok']))));
+s.add(Test('Archives', @()(0 == system([simpath ' DSLTests/difftests/archives.dsl | diff - DSLTests/difftests/archives.ok']))));
 if mode == INTERNAL
     s.add(Test('Scope', @()(0 == system([simpath ' DSLTests/difftests/scope.dsl | diff - DSLTests/difftests/scope.ok']))));
 end
@@ -21,6 +21,11 @@ end
 
 s = Suite(['Math Feature Tests ' target]);
 s.add(DerivativeTests(mode, target));
+s.add(LookupTableTests(mode, target));
+s.add(CommonSubexpressionTests(mode, target));
+s.add(FastMathTests(mode, target));
+s.add(SensitivityTests(mode, target));
+s.add(OptimizationTests(mode, target));
 
 end
 
@@ -43,3 +48,111 @@ s.add(Test('ForcedDerivative', @()(simex(['models_FeatureTests/' ...
                     'DerivativeTest3.dsl'], 10,target)), '-equal', struct('y', [0:10; 0:1:10; ones(1,11)]')));
 
 end
+
+function s = LookupTableTests(mode, target)
+
+s = Suite(['Lookup Table Tests ' target]);
+
+x = -5:5;
+s.add(Test('TabulatedIntermediate', @()(simex(['models_FeatureTests/' ...
+                    'LookupTableTest1.dsl'], 10, target, '-lookuptables')), '-approxequal', struct('y', [0:10; exp(-x/4) + sin(x)]')));
+
+% With a loose bound the smallest table is accepted, so interpolation errors
+% show up in the outputs; an exact evaluation would leave none
+    function y = InterpolatedValues
+        o = simex('models_FeatureTests/LookupTableTest1.dsl', 10, target, ...
+                  '-lookuptables', '-lookuptolerance=0.1', '-lookupfloor=0.1');
+        err = abs(o.y(:,2) - (exp(-x/4) + sin(x))');
+        y = max(err) > 1e-6 && max(err) < 0.1;
+    end
+s.add(Test('InterpolatesFromTable', @InterpolatedValues));
+
+end
+
+function s = CommonSubexpressionTests(mode, target)
+
+s = Suite(['Common Subexpression Tests ' target]);
+
+t = 0:10;
+s.add(Test('SharedWithOutputs', @()(simex(['models_FeatureTests/' ...
+                    'CommonSubexpressionTest1.dsl'], 10, target)), '-equal', struct('y', [t; 2*(t+1) + (t+1).^2; (t+1).^2 - 1; 2*(t+1) + (t+1).^2]')));
+s.add(Test('WithoutSharedExpressions', @()(simex(['models_FeatureTests/' ...
+                    'CommonSubexpressionTest1.dsl'], 10, target, '-hashcons=false')), '-equal', struct('y', [t; 2*(t+1) + (t+1).^2; (t+1).^2 - 1; 2*(t+1) + (t+1).^2]')));
+% The compiler logs how many expression nodes it shares, each time it shares them
+shared = Test('LogsSharedNodes', @()(simex(['models_FeatureTests/' ...
+                    'CommonSubexpressionTest1.dsl'], target, '-regenerateTimings', '-logdof')), '-regexpmatch', ...
+              'Shared \d+ expression nodes as \d+ distinct nodes');
+s.add(shared);
+s.add(Test('FewerDistinctNodes', @()(FewerDistinctNodes(shared.Output))));
+
+end
+
+% Checks that every sharing pass logged in str found repeated expression nodes
+function y = FewerDistinctNodes(str)
+counts = regexp(str, 'Shared (\d+) expression nodes as (\d+) distinct nodes', 'tokens');
+y = ~isempty(counts) && all(cellfun(@(c)(str2double(c{2}) < str2double(c{1})), counts));
+end
+
+function s = FastMathTests(mode, target)
+
+s = Suite(['Fast Math Tests ' target]);
+
+t = 0:10;
+x = t + 1;
+y = x.^3 + x.^(-2) + exp(x/10).*exp(x/20) + x + x/3;
+s.add(Test('StrengthReduction', @()(simex(['models_FeatureTests/' ...
+                    'FastMathTest1.dsl'], 10, target)), '-approxequal', struct('y', [t; y]')));
+s.add(Test('RelaxedPrecision', @()(simex(['models_FeatureTests/' ...
+                    'FastMathTest1.dsl'], 10, target, '-fastmath')), '-approxequal', struct('y', [t; y]')));
+
+end
+
+function s = OptimizationTests(mode, target)
+
+s = Suite(['Optimization Tests ' target]);
+
+% Levels 2 and above search for equivalent forms of each expression by saturation
+t = 0:10;
+a = t + 1;
+y = exp(a/10).*exp(a/20) + a.*a + 2*a + 1 + (a+1).*(a-1);
+s.add(Test('Unoptimized', @()(simex(['models_FeatureTests/' ...
+                    'OptimizationTest1.dsl'], 10, target, '-optimizelevel=0')), '-approxequal', struct('y', [t; y]')));
+    function e = SaturatedMatchesUnoptimized(level)
+        o0 = simex('models_FeatureTests/OptimizationTest1.dsl', 10, target, '-optimizelevel=0');
+        o = simex('models_FeatureTests/OptimizationTest1.dsl', 10, target, ['-optimizelevel=' num2str(level)]);
+        e = approx_equiv(o0, o, 1e-8);
+    end
+s.add(Test('SaturatedAtLevel2', @()(SaturatedMatchesUnoptimized(2))));
+s.add(Test('SaturatedAtLevel3', @()(SaturatedMatchesUnoptimized(3))));
+
+% The rule index and the memo of normal forms only skip rules and
+% subexpressions which cannot change, so bypassing them gives the same results
+    function e = IndexedMatchesUnindexed(model, level)
+        levelopt = ['-optimizelevel=' num2str(level)];
+        o = simex(model, 10, target, levelopt, '-regenerateTimings');
+        o_unindexed = simex(model, 10, target, levelopt, '-ruleindex=false', '-regenerateTimings');
+        e = equiv(o, o_unindexed);
+    end
+t = 0:10;
+a = t + 1; b = t + 2; c = t + 3;
+y = a + b + a.*b.*c + 6*a + 2*a - b + c.^3 + c + a;
+s.add(Test('VariadicRules', @()(simex(['models_FeatureTests/' ...
+                    'OptimizationTest2.dsl'], 10, target, '-optimizelevel=1')), '-approxequal', struct('y', [t; y]')));
+s.add(Test('VariadicRulesUnindexed', @()(IndexedMatchesUnindexed('models_FeatureTests/OptimizationTest2.dsl', 1))));
+s.add(Test('RulesUnindexedAtLevel1', @()(IndexedMatchesUnindexed('models_FeatureTests/OptimizationTest1.dsl', 1))));
+s.add(Test('RulesUnindexedAtLevel2', @()(IndexedMatchesUnindexed('models_FeatureTests/OptimizationTest1.dsl', 2))));
+
+end
+
+function s = SensitivityTests(mode, target)
+
+s = Suite(['Sensitivity Tests ' target]);
+
+% x' = -k*x has the solution x = exp(-k*t), whose derivative with respect to k is -t*exp(-k*t)
+t = 0:0.01:1;
+k = 0.5;
+s.add(Test('InputSensitivity', @()(simex(['models_FeatureTests/' ...
+                    'SensitivityTest1.dsl'], 1, target, '-sensitivity=k')), '-approxequal', ...
+           struct('x', [t; exp(-k*t)]', 'sensitivity_k', [t; -t.*exp(-k*t)]')));
+
+end
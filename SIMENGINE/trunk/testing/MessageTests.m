@@ -155,6 +155,17 @@ if mode == INTERNAL
     s.add(CreateUserErrorTest('InvalidIteratorOnState', 'IteratorTest8.dsl', ...
                               ['Temporal iterators can not be used as part of a state declaration']));
 end
+
+% Only mixed precision warns of a tolerance finer than its float storage
+tolerancewarning = 'too fine for mixed precision storage';
+s.add(Test('FineToleranceWithMixedPrecision', ...
+           @()(simex('models_MessageTests/IteratorTest9.dsl', 1, '-mixed')), ...
+           '-regexpmatch', tolerancewarning));
+    function e = NoWarningWithSinglePrecision
+        out = evalc('simex(''models_MessageTests/IteratorTest9.dsl'', 1, ''-single'')');
+        e = isempty(strfind(out, tolerancewarning));
+    end
+s.add(Test('FineToleranceWithSinglePrecision', @NoWarningWithSinglePrecision));
                       
 end
 
@@ -230,5 +241,9 @@ if mode == INTERNAL
 end
 s.add(CreateUserErrorTest('DifferentialEquation', ...
                           'EquationTest3.dsl', 'Invalid derivative reference on symbol'))
+s.add(CreateUserErrorTest('WienerNoiseThroughIntermediate', ...
+                          'EquationTest4.dsl', 'contains wiener\(\) noise'))
+s.add(CreateUserErrorTest('NonlinearWienerNoise', ...
+                          'EquationTest5.dsl', 'uses wiener\(\) non-linearly'))
 
 end
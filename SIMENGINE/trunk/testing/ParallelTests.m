@@ -11,6 +11,7 @@ if strcmpi(target, '-cpu')
   s.add(DuplicateStatesTarget('-parallelcpu'));
   s.add(Test('split_fn submodel parallelcpu', @()(DuplicateStates('models_FeatureTests/split_fn.dsl', 10, '-double', '-parallelcpu', 2))));
   s.add(Test('fn_imp explicit/implicit parallelcpu', @()(DuplicateStates('models_FeatureTests/fn_imp.dsl',10, '-double', '-parallelcpu', 10))));
+  s.add(Test('parareal rk4 parallelcpu', @()(PararealVsSerial('models_SolverTests/fn_rk4.dsl', 100, 4))));
 %  s.add(Test('MRG parallel test', @RunMRGSerialvsParallel));
 
 else
@@ -33,6 +34,13 @@ function e = DuplicateStates(model, runtime, precision, target, number)
     e = all_equiv(o);
 end
 
+% Splits the time interval of a single instance into slices and compares against an unsplit run
+function e = PararealVsSerial(model, runtime, slices)
+    oserial = simex(model, runtime, '-double', '-cpu');
+    oparareal = simex(model, runtime, '-double', '-parallelcpu', '-parareal', slices, '-parareal_tolerance', 1e-9);
+    e = approx_equiv(oserial, oparareal, 1e-3);
+end
+
 function s = DuplicateStatesTarget(target)
 
 s = Suite(['Duplicate Default States ' target]);
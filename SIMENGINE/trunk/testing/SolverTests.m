@@ -38,8 +38,9 @@ end
 
 % Run just one model, FN, across each of the solvers
 solvers = {'forwardeuler', 'rk4', 'ode23', 'ode45', 'expeuler', 'cvode', ...
-           'cvode_stiff', 'cvode_nonstiff', 'cvode_diag', 'cvode_tridiag'};
-precisions = {'single', 'double'};
+           'cvode_stiff', 'cvode_nonstiff', 'cvode_diag', 'cvode_tridiag', ...
+           'ros3', 'rodas3', 'autostiff', 'multirate'};
+precisions = {'single', 'double', 'mixed'};
 for i=1:length(solvers)
     solver = solvers{i};
     for j=1:length(precisions)
@@ -78,9 +79,38 @@ for i=1:length(solvers)
 
 end
 
+% The per-instance solver statistics of a variable timestep solver should
+% agree with the steps seen in its outputs
+if mode == RUNTESTS
+    s.add(Test('fn_ode45_solver_stats', @()(SolverStatsConsistent('models_SolverTests/fn_ode45.dsl', 100))));
+end
 
 end
 
+% Runs a model with a single continuous iterator in debug mode, which keeps the
+% simulation data directory, and checks the steps accepted, steps rejected and flow
+% evaluations written to its solver-stats file.  Every accepted step produces an
+% output sample and every attempted step of the Dormand-Prince solver evaluates the
+% flows at least six times, plus once more at the start of an accepted step.
+function e = SolverStatsConsistent(model, time)
+
+[out, o] = evalc('simex(model, time, ''-debug'')');
+datadir = regexp(out, 'temporary data directory (\S+)', 'tokens', 'once');
+fid = fopen(fullfile(datadir{1}, 'solver-stats'), 'r');
+stats = fread(fid, inf, 'double');
+fclose(fid);
+rmdir(datadir{1}, 's');
+delete('debug-last');
+
+accepted = stats(1);
+rejected = stats(2);
+flows = stats(3);
+e = length(stats) == 3 && ...
+    accepted == size(o.u, 1) - 1 && ...
+    rejected < accepted && ...
+    flows >= 7*accepted + 6*rejected;
+
+end
 
 function reduced = reduceDataSet(dataset)
 
@@ -46,10 +46,51 @@ s.add(Test('DuplicateSubModelToOutputTest', @()(simex(['models_FeatureTests/' ..
 s.add(Test('SubModelDefaultInputTest', @()(simex(['models_FeatureTests/' ...
                     'SubModelTest5.dsl'], 10,target)), '-equal', ...
            struct('y', [0:10; 0:2:20; 0:2:20; 0:10]')));
+s.add(Test('DuplicateSubModelWithoutInstanceLoopsTest', @()(simex(['models_FeatureTests/' ...
+                    'SubModelTest3.dsl'], 10,target, '-instanceloops=false')), '-equal', ...
+           struct('y', [0:10; 0:2:20; 0:10; 0:3:30]')));
+s.add(Test('ManyInstancesInLoopsTest', @()(simex(['models_FeatureTests/' ...
+                    'SubModelTest8.dsl'], 10,target)), '-equal', ...
+           struct('y', [0:10; 0:2:20; 0:130:1300; 0:260:2600; 0:17030:170300]')));
+    function y = ManyInstancesWithoutInstanceLoops
+        o1 = simex('models_FeatureTests/SubModelTest8.dsl', 10, target);
+        o2 = simex('models_FeatureTests/SubModelTest8.dsl', 10, target, '-instanceloops=false');
+        y = equiv(o1, o2);
+    end
+s.add(Test('ManyInstancesWithoutInstanceLoopsTest', @ManyInstancesWithoutInstanceLoops));
 
 INTERNAL = 0; RELEASE = 1;
 
 % this is related to init values driven by inputs
+    % Compiles a hierarchical model three times in a new cache directory: first from the
+    % DSL, then from its cached translation, then again from the DSL once the cached
+    % translation is truncated
+    function e = CompiledFromCachedTranslation
+        cachedir = tempname;
+        model = 'models_FeatureTests/SubModelTest3.dsl';
+        cacheopt = ['-cachedir=' cachedir];
+        [out1, o1] = evalc('simex(model, 10, target, ''-regenerateTimings'', ''-debug'', cacheopt)');
+        [out2, o2] = evalc('simex(model, 10, target, ''-regenerateTimings'', ''-debug'', cacheopt)');
+        doffiles = dir(fullfile(cachedir, '*.dof'));
+        % Truncates each translation to half its length
+        for i = 1:length(doffiles)
+            doffile = fullfile(cachedir, doffiles(i).name);
+            fid = fopen(doffile, 'r');
+            data = fread(fid, inf, 'uint8=>uint8');
+            fclose(fid);
+            fid = fopen(doffile, 'w');
+            fwrite(fid, data(1:floor(end/2)));
+            fclose(fid);
+        end
+        [out3, o3] = evalc('simex(model, 10, target, ''-regenerateTimings'', ''-debug'', cacheopt)');
+        rmdir(cachedir, 's');
+        reused = 'Compiled from the cached translation';
+        e = isempty(strfind(out1, reused)) && ~isempty(strfind(out2, reused)) && ...
+            isempty(strfind(out3, reused)) && ~isempty(doffiles) && ...
+            equiv(o1, o2) && equiv(o1, o3) && ...
+            equiv(o1, struct('y', [0:10; 0:2:20; 0:10; 0:3:30]'));
+    end
+s.add(Test('CompiledFromCachedTranslationTest', @CompiledFromCachedTranslation));
 s.add(Test('SubModelInputToInitTest', @()(simex(['models_FeatureTests/' ...
                     'SubModelTest6.dsl'], 10,target)), '-equal', struct('y', [0:10; 0:2:20; 0:10]')));
 
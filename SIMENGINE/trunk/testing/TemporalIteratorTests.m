@@ -60,6 +60,9 @@ s.add(Test('UpdateThreeStatesAggregated',@ ...
            ()(simex('models_FeatureTests/UpdateContinuousIteratorTest6.dsl',10,target,'-aggregate')), '-equal', struct('x', [0:10; sawtooth; sawtooth; sawtooth]')));
 s.add(Test('UpdateFromTime',@ ...
            ()(simex('models_FeatureTests/UpdateContinuousIteratorTest7.dsl',10,target)), '-equal', struct('x', [0:10; sawtooth]')));
+% the variable step solver stops at each crossing rather than stepping past it
+s.add(Test('UpdateLocatedEvent',@()(all(subsref(simex('models_FeatureTests/UpdateContinuousIteratorTest8.dsl',10,target), substruct('.','x','()',{':',2})) <= 2.5 + 1e-6))));
+s.add(Test('UpdateLocatedEventTimes',@()(all(ismember([2.5 5], round(1e6*subsref(simex('models_FeatureTests/UpdateContinuousIteratorTest8.dsl',10,target), substruct('.','x','()',{':',1})))/1e6)))));
 
 
 % Parallel tests
@@ -167,6 +170,7 @@ s = Suite(['Multiple Temporal Iterators through Sub-Model Tests ' target]);
 
 s.add(Test('UpdateExpInSubModel', @()(simex('models_FeatureTests/TemporalIteratorSubModelsTest1.dsl',10,target)), '-equal', struct('y', [0:10; mod(0:10,4)]')));
 s.add(Test('TwoIteratorsAcrossSubModels', @()(simex('models_FeatureTests/TemporalIteratorSubModelsTest2.dsl',10,target)), '-equal', struct('y1', [0:10; 0:10]','y2', [0:10; 0:2:20]')));
+s.add(Test('TwoIteratorsInOneSourceFile', @()(simex('models_FeatureTests/TemporalIteratorSubModelsTest2.dsl',10,target,'-splitflows=false')), '-equal', struct('y1', [0:10; 0:10]','y2', [0:10; 0:2:20]')));
 s.add(Test('TwoIteratorsMixedAcrossSubModels',  @()(simex('models_FeatureTests/TemporalIteratorSubModelsTest3.dsl',10,target)), '-equal', struct('y1', [0:10; 0:10; 0:2:20]','y2', [0:10; 0:2:20; 0:4:40]')));
 s.add(Test('MoreComplexTwoIteratorsMixedAcrossSubModels', @()(simex('models_FeatureTests/TemporalIteratorSubModelsTest4.dsl',10,target)), '-equal', ...
                      struct('ya', [0:10; 0:10; 0:2:20]', ...